@@ -0,0 +1,154 @@
+#include "accel.h"
+
+// A body spinning with the arm at its side pushes the watch outwards, so the
+// measured acceleration grows beyond gravity by the centripetal term w^2 * r.
+// Gravity is not assumed to be 1000 mg: sensor gain and offset errors are
+// larger than a slow spin, so the resting vector is measured while the watch
+// is still, which also covers the ringing time before the hold starts.
+// Everything below is integer-only: mg in, trig angle units out.
+#define ARM_RADIUS_MM 400
+#define MIN_CENTRIPETAL_MG 150    // below this it is wrist fidgeting, not a spin
+#define MIN_SUSTAINED_SAMPLES 10  // and it has to last, shakes and bumps do not
+#define FILTER_SHIFT 3            // low-pass y += (x - y) >> FILTER_SHIFT
+#define BASELINE_SHIFT 6          // resting gravity follows over ~2.5 s of quiet samples
+#define STEP_ANGLE (10 * TRIG_MAX_ANGLE / 360)
+
+static AccelSpinState s_state;
+static SpinHeadingHandler s_handler;
+
+static uint32_t isqrt(uint32_t n){
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  
+  while(bit > n)
+    bit >>= 2;
+  while(bit != 0) {
+    if(n >= root + bit) {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+void accel_spin_reset(AccelSpinState *state){
+  state->x = state->y = state->z = 0;
+  state->gx = state->gy = state->gz = 0;
+  state->px = state->py = state->pz = 0;
+  state->residual = 0;
+  state->heading = 0;
+  state->step = 0;
+  state->sustained = 0;
+  state->primed = false;
+}
+
+// A spin pulls the watch the same way, towards the body, for as long as it
+// lasts. Shaking the arm swings the pull back and forth.
+static bool same_direction(int32_t ax, int32_t ay, int32_t az, int32_t bx, int32_t by, int32_t bz){
+  int64_t dot = (int64_t)ax * bx + (int64_t)ay * by + (int64_t)az * bz;
+  int64_t a2 = (int64_t)ax * ax + (int64_t)ay * ay + (int64_t)az * az;
+  int64_t b2 = (int64_t)bx * bx + (int64_t)by * by + (int64_t)bz * bz;
+  // Within 45 degrees: cos^2 >= 1/2
+  return dot > 0 && 2 * dot * dot >= a2 * b2;
+}
+
+static void accel_spin_sample(AccelSpinState *state, AccelData *sample){
+  if(!state->primed) {
+    state->x = sample->x << FILTER_SHIFT;
+    state->y = sample->y << FILTER_SHIFT;
+    state->z = sample->z << FILTER_SHIFT;
+    state->gx = sample->x << BASELINE_SHIFT;
+    state->gy = sample->y << BASELINE_SHIFT;
+    state->gz = sample->z << BASELINE_SHIFT;
+    state->primed = true;
+    return;
+  }
+  // Fixed point, so the filters have no dead band
+  state->x += sample->x - (state->x >> FILTER_SHIFT);
+  state->y += sample->y - (state->y >> FILTER_SHIFT);
+  state->z += sample->z - (state->z >> FILTER_SHIFT);
+  int32_t ax = state->x >> FILTER_SHIFT, ay = state->y >> FILTER_SHIFT, az = state->z >> FILTER_SHIFT;
+  int32_t gx = state->gx >> BASELINE_SHIFT, gy = state->gy >> BASELINE_SHIFT, gz = state->gz >> BASELINE_SHIFT;
+  
+  // Centripetal part, perpendicular to gravity: a_c^2 = |a|^2 - |g|^2.
+  // Tilting the wrist turns the vector but leaves its length alone.
+  int32_t g2 = gx * gx + gy * gy + gz * gz;
+  int32_t centripetal2 = ax * ax + ay * ay + az * az - g2;
+  state->step = 0;
+  
+  // The outward pull is what is left after removing the gravity component, for
+  // a spin it carries the whole excess. A longer vector along gravity is a
+  // baseline that is still settling.
+  int32_t px = 0, py = 0, pz = 0;
+  if(g2 > 0) {
+    int64_t along = (int64_t)ax * gx + (int64_t)ay * gy + (int64_t)az * gz;
+    px = ax - (int32_t)(gx * along / g2);
+    py = ay - (int32_t)(gy * along / g2);
+    pz = az - (int32_t)(gz * along / g2);
+  }
+  int32_t pull2 = px * px + py * py + pz * pz;
+  if(g2 == 0 || centripetal2 < MIN_CENTRIPETAL_MG * MIN_CENTRIPETAL_MG ||
+     4 * pull2 < MIN_CENTRIPETAL_MG * MIN_CENTRIPETAL_MG) {
+    // Quiet, let the resting vector follow slow drift and tilt
+    state->gx += ax - gx;
+    state->gy += ay - gy;
+    state->gz += az - gz;
+    state->sustained = 0;
+    return;
+  }
+  
+  if(state->sustained == 0 || !same_direction(px, py, pz, state->px, state->py, state->pz)) {
+    state->px = px;
+    state->py = py;
+    state->pz = pz;
+    state->sustained = 1;
+    return;
+  }
+  if(state->sustained < MIN_SUSTAINED_SAMPLES) {
+    state->sustained++;
+    return;
+  }
+  
+  // w = sqrt(a_c / r), in mrad/s
+  int32_t centripetal_mm = (int32_t)isqrt(centripetal2) * 981 / 100;
+  int32_t omega = (int32_t)isqrt((uint32_t)(centripetal_mm * 1000 / ARM_RADIUS_MM) * 1000);
+  
+  // Integrate over one sample period
+  state->step = omega * TRIG_MAX_ANGLE / 6283 / ACCEL_SPIN_SAMPLING_RATE;
+}
+
+void accel_spin_process(AccelSpinState *state, AccelData *data, uint32_t num_samples, SpinHeadingHandler handler){
+  for(uint32_t i = 0; i < num_samples; i++) {
+    // Vibration corrupts the sample, assume the last rotation rate held
+    if(!data[i].did_vibrate)
+      accel_spin_sample(state, &data[i]);
+    state->residual += state->step;
+  }
+  
+  // Emit one detector step per 10 degrees so the compass step size still applies.
+  // The heading is left unwrapped; the detector only looks at differences.
+  while(state->residual >= STEP_ANGLE) {
+    state->residual -= STEP_ANGLE;
+    state->heading -= STEP_ANGLE;
+    handler(state->heading);
+  }
+}
+
+static void accel_data_handler(AccelData *data, uint32_t num_samples){
+  accel_spin_process(&s_state, data, num_samples, s_handler);
+}
+
+void accel_spin_subscribe(SpinHeadingHandler handler){
+  s_handler = handler;
+  accel_spin_reset(&s_state);
+  accel_data_service_subscribe(ACCEL_SPIN_SAMPLES_PER_UPDATE, accel_data_handler);
+  accel_service_set_sampling_rate(ACCEL_SPIN_SAMPLING_RATE);
+}
+
+void accel_spin_unsubscribe(void){
+  accel_data_service_unsubscribe();
+  s_handler = NULL;
+}
\ No newline at end of file
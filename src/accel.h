@@ -0,0 +1,25 @@
+#pragma once
+
+#include <pebble.h>
+#include "spin.h"
+
+// Batch size trades detection latency against callback overhead
+#define ACCEL_SPIN_SAMPLING_RATE ACCEL_SAMPLING_25HZ
+#define ACCEL_SPIN_SAMPLES_PER_UPDATE 10
+
+typedef struct AccelSpinState{
+  int32_t x, y, z;    // low-passed axes in mg << FILTER_SHIFT
+  int32_t gx, gy, gz; // resting gravity as this sensor measures it, mg << BASELINE_SHIFT
+  int32_t px, py, pz; // sideways pull when the current run started, in mg
+  int32_t residual;   // rotation not yet emitted, in trig angle units
+  int32_t step;       // rotation over the last usable sample
+  int32_t heading;    // synthetic heading handed to the spin detector
+  uint8_t sustained;  // consecutive samples of a steady outward pull
+  bool primed;
+}AccelSpinState;
+
+void accel_spin_reset(AccelSpinState *state);
+void accel_spin_process(AccelSpinState *state, AccelData *data, uint32_t num_samples, SpinHeadingHandler handler);
+
+void accel_spin_subscribe(SpinHeadingHandler handler);
+void accel_spin_unsubscribe(void);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "alarm.h"
+#include "storage.h"
 
 #define SECOND 60
 #define MINUTE 60
@@ -26,30 +27,71 @@ time_t alarm_get_time_of_wakeup(Alarm *alarm)
     time_t now = time(NULL);
     time_t timestamp = clock_to_timestamp_precise(TODAY,alarm->hour,alarm->minute);
     
-    if((now-timestamp)<=0) {
-      timestamp = (time_t)(HOUR*MINUTE*SECOND) + clock_to_timestamp_precise(TODAY,alarm->hour,alarm->minute);
+    // TODAY rolls a time that has already passed over to next week, ask for tomorrow instead
+    if((timestamp-now)>(time_t)(HOUR*MINUTE*SECOND)) {
+      struct tm *t = localtime(&now);
+      timestamp = clock_to_timestamp_precise((t->tm_wday+1)%7+1,alarm->hour,alarm->minute);
     }
     return timestamp;
   }
   return -1;
 }
 
-void reschedule_wakeup(Alarm *alarm)
+int alarm_next(time_t *timestamp)
 {
-  wakeup_cancel_all();
-  
-  time_t timestamp = time(NULL)+(60*60*24*7); // now + 1 week
-  APP_LOG(APP_LOG_LEVEL_DEBUG,"Now has timestamp %d",(int)timestamp);
-//   int alarm_id=-1;
-  time_t alarm_time = alarm_get_time_of_wakeup(alarm);
-  if(alarm_time<0)
-    return;
-  if(alarm_time<timestamp)
+  int next = -1;
+  int count = storage_alarm_count();
+  *timestamp = time(NULL)+(60*60*24*7); // now + 1 week
+  for(int i = 0; i < count; i++)
   {
-    timestamp = alarm_time;
-    alarm->alarm_id = wakeup_schedule(timestamp,0,true);
-//     APP_LOG(APP_LOG_LEVEL_DEBUG,"Scheduling Alarm %d",alarm_id);
-    struct tm *t = localtime(&timestamp);
-    APP_LOG(APP_LOG_LEVEL_DEBUG,"Scheduled at %d.%d %d:%d",t->tm_mday, t->tm_mon+1,t->tm_hour,t->tm_min);
+    time_t alarm_time = alarm_get_time_of_wakeup(storage_get_alarm(i));
+    if(alarm_time>=0 && alarm_time<*timestamp)
+    {
+      *timestamp = alarm_time;
+      next = i;
+    }
   }
+  return next;
+}
+
+void reschedule_wakeup(void)
+{
+  // Cancel only the recurring wakeups, one page at a time, pending snoozes keep their slots
+  int count = storage_alarm_count();
+  for(int i = 0; i < count; i++)
+  {
+    Alarm *alarm = storage_get_alarm(i);
+    if(alarm->alarm_id != -1)
+    {
+      wakeup_cancel(alarm->alarm_id);
+      Alarm cleared = *alarm;
+      cleared.alarm_id = -1;
+      storage_set_alarm(i, &cleared);
+    }
+  }
+  
+  time_t timestamp;
+  int next = alarm_next(&timestamp);
+  storage_set_scheduled(next);
+  if(next<0)
+    return;
+  
+  Alarm alarm = *storage_get_alarm(next);
+  alarm.alarm_id = wakeup_schedule(timestamp,next,true);
+  storage_set_alarm(next, &alarm);
+#if FEATURE_DEBUG_LOG
+  struct tm *t = localtime(&timestamp);
+  DEBUG_LOG("Scheduled alarm %d at %d.%d %d:%d",next,t->tm_mday, t->tm_mon+1,t->tm_hour,t->tm_min);
+#endif
+}
+
+WakeupId alarm_snooze(int index, int minutes)
+{
+  time_t timestamp = time(NULL) + minutes*60;
+  WakeupId id = wakeup_schedule(timestamp, index | WAKEUP_SNOOZE, true);
+  if(id < 0)
+    APP_LOG(APP_LOG_LEVEL_ERROR,"Snooze for alarm %d failed: %d",index,(int)id);
+  else
+    DEBUG_LOG("Snoozed alarm %d for %d min",index,minutes);
+  return id;
 }
\ No newline at end of file
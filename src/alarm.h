@@ -1,9 +1,15 @@
 #pragma once
-  
+
 #include <pebble.h>
-  
-#define NUM_ALARMS 1
-  
+#include "feature_switches.h"
+
+#define MAX_ALARMS 32
+#define DEFAULT_SNOOZE_MINUTES 9
+
+// Wakeup cookies carry the alarm index, this bit marks a one-off snooze wakeup
+#define WAKEUP_SNOOZE 0x10000
+#define WAKEUP_ALARM_INDEX(cookie) ((cookie) & (WAKEUP_SNOOZE - 1))
+
 typedef struct Alarm{
   unsigned char hour;
   unsigned char minute;
@@ -13,4 +19,7 @@ typedef struct Alarm{
 
 void convert_24_to_12(int hour_in, int* hour_out, bool* am);
 time_t alarm_get_time_of_wakeup(Alarm *alarm);
-void reschedule_wakeup(Alarm *alarm);
\ No newline at end of file
+// Index of the enabled alarm that fires next and its time, -1 when none is due within a week
+int alarm_next(time_t *timestamp);
+void reschedule_wakeup(void);
+WakeupId alarm_snooze(int index, int minutes);
\ No newline at end of file
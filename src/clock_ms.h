@@ -0,0 +1,12 @@
+#pragma once
+
+#include <pebble.h>
+
+// Wall clock in ms for measuring short intervals, wraps every 49 days so
+// only differences between two readings are meaningful
+static inline uint32_t now_ms(void){
+  time_t seconds;
+  uint16_t millis;
+  time_ms(&seconds, &millis);
+  return (uint32_t)seconds * 1000 + millis;
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "edit.h"
 #include "settings.h"
 #include "alarm.h"
+#include "latency.h"
+#include "format.h"
 
 #define PIN_WINDOW_SPACING 24
   
@@ -24,10 +26,12 @@ static int s_selection;
 
 static Alarm temp_alarm;
 static Alarm *current_alarm;
+static EditSavedHandler s_saved_handler;
 
-void win_edit_show(Alarm *alarm){
+void win_edit_show(Alarm *alarm, EditSavedHandler saved){
   memcpy(&temp_alarm,alarm,sizeof(Alarm));
   current_alarm = alarm;
+  s_saved_handler = saved;
 //   s_select_all = false;
   s_max[2]=1;s_min[2]=0;
   s_max[1]=59;s_min[1]=0;
@@ -63,7 +67,8 @@ void win_edit_show(Alarm *alarm){
 }
 
 static void update_ui(Layer *layer, GContext *ctx) {
-  
+  latency_stop(LATENCY_EDIT);
+
   for(int i = 0; i < 3; i++) {
 #ifdef PBL_COLOR
     text_layer_set_background_color(s_input_layers[i], (i == s_selection) ? GColorDukeBlue : GColorDarkGray);
@@ -101,10 +106,11 @@ static void update_ui(Layer *layer, GContext *ctx) {
       gpath_draw_filled(ctx, s_my_path_ptr);
     }
 #endif
+    char *end = s_value_buffers[i] + sizeof(s_value_buffers[i]);
     if(i<2)
-      snprintf(s_value_buffers[i], sizeof("00"), "%02d", s_digits[i]);
+      format_two_digits(s_value_buffers[i], end, s_digits[i]);
     else
-      snprintf(s_value_buffers[i], sizeof("AM"), s_digits[i]?"AM":"PM");
+      format_str(s_value_buffers[i], end, s_digits[i]?"AM":"PM");
     text_layer_set_text(s_input_layers[i], s_value_buffers[i]);
   }
   layer_set_hidden(text_layer_get_layer(s_input_layers[2]),!s_withampm);
@@ -138,10 +144,14 @@ static void select_click_handler(ClickRecognizerRef recognizer, void *context) {
     } 
     memcpy(current_alarm,&temp_alarm,sizeof(Alarm));      
     window_stack_pop(true);
+    if(s_saved_handler)
+      s_saved_handler(current_alarm);
     s_selection--;
   }
-  else
+  else {
+    latency_start(LATENCY_EDIT);
     layer_mark_dirty(s_canvas_layer);
+  }
 }
 
 static void back_click_handler(ClickRecognizerRef recognizer, void *context) {
@@ -156,6 +166,7 @@ static void back_click_handler(ClickRecognizerRef recognizer, void *context) {
 }
 
 static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
+  latency_start(LATENCY_EDIT);
   if(s_selection == 0 && s_withampm && s_digits[s_selection] == s_max[s_selection] - 1)
     s_digits[2] = !s_digits[2];
   
@@ -168,6 +179,7 @@ static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
 }
 
 static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
+  latency_start(LATENCY_EDIT);
   if(s_selection == 0 && s_withampm && s_digits[s_selection] == s_max[s_selection])
     s_digits[2] = !s_digits[2];
 	  
@@ -3,5 +3,7 @@
 #include <pebble.h>
 #include "settings.h"
   
+typedef void (*EditSavedHandler)(Alarm *alarm);
+
 void win_edit_init(void);
-void win_edit_show(Alarm* alarm);
\ No newline at end of file
+void win_edit_show(Alarm* alarm, EditSavedHandler saved);
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <pebble.h>
+
+// Compile-time feature switches, set per build variant by the wscript
+// (--variant, --features). A plain build keeps everything.
+
+// Tutorial row in the settings and the tutorial session
+#ifndef FEATURE_TUTORIAL
+#define FEATURE_TUTORIAL 1
+#endif
+// Debug level APP_LOG output
+#ifndef FEATURE_DEBUG_LOG
+#define FEATURE_DEBUG_LOG 1
+#endif
+// Latency sample history and its settings row
+#ifndef FEATURE_HISTORY
+#define FEATURE_HISTORY 1
+#endif
+// Session transition trace
+#ifndef FEATURE_TRACE
+#define FEATURE_TRACE 1
+#endif
+
+#if FEATURE_DEBUG_LOG
+#define DEBUG_LOG(fmt, ...) APP_LOG(APP_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define DEBUG_LOG(fmt, ...) do {} while(0)
+#endif
\ No newline at end of file
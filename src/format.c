@@ -0,0 +1,57 @@
+#include "format.h"
+#include "alarm.h"
+
+static char *put(char *out, char *end, char c){
+  if(out + 1 < end)
+    *out++ = c;
+  if(out < end)
+    *out = '\0';
+  return out;
+}
+
+char *format_str(char *out, char *end, const char *text){
+  if(out < end)
+    *out = '\0';
+  while(*text)
+    out = put(out, end, *text++);
+  return out;
+}
+
+char *format_int(char *out, char *end, int value){
+  char digits[10];
+  int n = 0;
+  // Work on the negative value so INT_MIN does not overflow
+  int rest = value < 0 ? value : -value;
+  
+  if(out < end)
+    *out = '\0';
+  if(value < 0)
+    out = put(out, end, '-');
+  do {
+    digits[n++] = '0' - rest % 10;
+    rest /= 10;
+  } while(rest);
+  while(n)
+    out = put(out, end, digits[--n]);
+  return out;
+}
+
+char *format_two_digits(char *out, char *end, int value){
+  if(out < end)
+    *out = '\0';
+  out = put(out, end, '0' + (value / 10) % 10);
+  return put(out, end, '0' + value % 10);
+}
+
+char *format_time(char *out, char *end, int hour, int minute, bool is_24h){
+  bool is_am = true;
+  
+  if(!is_24h)
+    convert_24_to_12(hour, &hour, &is_am);
+  out = format_int(out, end, hour);
+  out = put(out, end, ':');
+  out = format_two_digits(out, end, minute);
+  if(!is_24h)
+    out = format_str(out, end, is_am ? " AM" : " PM");
+  return out;
+}
\ No newline at end of file
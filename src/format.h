@@ -0,0 +1,14 @@
+#pragma once
+
+#include <pebble.h>
+
+// Allocation-free formatting for the draw paths, in place of snprintf/strftime.
+// Each call writes at out, never past end, always NUL-terminates when there is
+// room, and returns the position of the terminator so calls can be chained.
+#define FORMAT_TIME_LENGTH sizeof("12:00 AM")
+
+char *format_str(char *out, char *end, const char *text);
+char *format_int(char *out, char *end, int value);
+char *format_two_digits(char *out, char *end, int value);
+// "H:MM" on 24h watches, "H:MM AM" otherwise
+char *format_time(char *out, char *end, int hour, int minute, bool is_24h);
\ No newline at end of file
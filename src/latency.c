@@ -0,0 +1,89 @@
+#include "latency.h"
+#include "clock_ms.h"
+
+#if FEATURE_HISTORY
+
+typedef struct LatencyProbe{
+  uint32_t started;             // ms, only meaningful while pending
+  bool pending;
+  uint16_t samples[LATENCY_SAMPLES];
+  uint16_t count;               // total samples recorded, ring index is count % LATENCY_SAMPLES
+}LatencyProbe;
+
+static LatencyProbe s_probes[NUM_LATENCY_KINDS];
+
+static const char *s_names[NUM_LATENCY_KINDS] = { "Hold", "Release", "Spin", "Edit" };
+
+void latency_start(LatencyKind kind){
+  // Keep the oldest pending input, repeats before the next draw wait just as long
+  if(!s_probes[kind].pending) {
+    s_probes[kind].started = now_ms();
+    s_probes[kind].pending = true;
+  }
+}
+
+void latency_stop(LatencyKind kind){
+  LatencyProbe *probe = &s_probes[kind];
+  if(!probe->pending)
+    return;
+  
+  uint32_t elapsed = now_ms() - probe->started;
+  probe->samples[probe->count % LATENCY_SAMPLES] = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+  probe->count++;
+  probe->pending = false;
+}
+
+void latency_get_stats(LatencyKind kind, LatencyStats *stats){
+  LatencyProbe *probe = &s_probes[kind];
+  uint16_t sorted[LATENCY_SAMPLES];
+  uint16_t n = probe->count < LATENCY_SAMPLES ? probe->count : LATENCY_SAMPLES;
+  uint32_t sum = 0;
+  
+  stats->count = probe->count;
+  if(n == 0) {
+    stats->min = stats->avg = stats->max = stats->p95 = 0;
+    return;
+  }
+  
+  // Insertion sort, the window is tiny
+  for(int i = 0; i < n; i++) {
+    uint16_t value = probe->samples[i];
+    int j = i;
+    sum += value;
+    for(; j > 0 && sorted[j - 1] > value; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = value;
+  }
+  stats->min = sorted[0];
+  stats->max = sorted[n - 1];
+  stats->avg = sum / n;
+  stats->p95 = sorted[(n * 95 - 1) / 100];
+}
+
+const char *latency_name(LatencyKind kind){
+  return s_names[kind];
+}
+
+// Dump the raw sample rings as "LAT <kind> <count> <offset> <hex>" lines of
+// LOG_CHUNK samples each, decoded on the host by tools/latency_decode.py
+#define LOG_CHUNK 16
+
+void latency_log(void){
+  static const char hex[] = "0123456789abcdef";
+  char buffer[LOG_CHUNK * 4 + 1];
+  
+  for(int kind = 0; kind < NUM_LATENCY_KINDS; kind++) {
+    LatencyProbe *probe = &s_probes[kind];
+    uint16_t n = probe->count < LATENCY_SAMPLES ? probe->count : LATENCY_SAMPLES;
+    for(int offset = 0; offset < n; offset += LOG_CHUNK) {
+      int len = 0;
+      for(int i = offset; i < n && i < offset + LOG_CHUNK; i++) {
+        for(int shift = 12; shift >= 0; shift -= 4)
+          buffer[len++] = hex[(probe->samples[i] >> shift) & 0xf];
+      }
+      buffer[len] = '\0';
+      APP_LOG(APP_LOG_LEVEL_INFO, "LAT %d %d %d %s", kind, (int)probe->count, offset, buffer);
+    }
+  }
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pebble.h>
+#include "feature_switches.h"
+
+// Input-to-draw latency probes. A probe is started in the click or sensor
+// handler and stopped by the update proc that shows the result.
+#define LATENCY_SAMPLES 32
+
+typedef enum LatencyKind{
+  LATENCY_HOLD=0,
+  LATENCY_RELEASE=1,
+  LATENCY_SPIN=2,
+  LATENCY_EDIT=3,
+  NUM_LATENCY_KINDS
+}LatencyKind;
+
+typedef struct LatencyStats{
+  uint16_t count;
+  uint16_t min;
+  uint16_t avg;
+  uint16_t max;
+  uint16_t p95;
+}LatencyStats;
+
+#if FEATURE_HISTORY
+void latency_start(LatencyKind kind);
+void latency_stop(LatencyKind kind);
+#else
+// Probes compile away without the history feature
+static inline void latency_start(LatencyKind kind){}
+static inline void latency_stop(LatencyKind kind){}
+#endif
+void latency_get_stats(LatencyKind kind, LatencyStats *stats);
+const char *latency_name(LatencyKind kind);
+void latency_log(void);
\ No newline at end of file
@@ -1,21 +1,21 @@
 #include <pebble.h>
 #include "main.h"
+#include "feature_switches.h"
 #include "storage.h"
 #include "wakeup.h"
 
-struct Alarm alarm;
 static bool snooze;
   
 static void init() {
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "main init - called");
-  load_persistent_storage_alarm(&alarm);
-  perform_wakeup_tasks(&alarm,&snooze);
+  DEBUG_LOG("main init - called");
+  storage_init();
+  perform_wakeup_tasks(&snooze);
 }
 
 static void deinit() {
   if(!snooze)
-    reschedule_wakeup(&alarm);
-  write_persistent_storage_alarm(&alarm);
+    reschedule_wakeup();
+  storage_deinit();
 }
 
 int main(void) {
@@ -0,0 +1,50 @@
+#include "power.h"
+#include "spin.h"
+
+static const PowerProfile PROFILES[NUM_POWER_LEVELS] = {
+  [POWER_NORMAL]   = { 1000, 1000, SPIN_HEADING_FILTER_DEG, 0, true, false },
+  [POWER_LOW]      = { 300, 1700, POWER_HEADING_FILTER_DEG, 250, false, false },
+  [POWER_CRITICAL] = { 300, 1700, POWER_HEADING_FILTER_DEG, 250, false, true },
+};
+
+static PowerLevel s_level = POWER_NORMAL;
+static PowerChangedHandler s_handler;
+
+static PowerLevel level_for(BatteryChargeState charge){
+  if(charge.is_charging || charge.is_plugged)
+    return POWER_NORMAL;
+  if(charge.charge_percent <= POWER_CRITICAL_PERCENT)
+    return POWER_CRITICAL;
+  if(charge.charge_percent <= POWER_LOW_PERCENT)
+    return POWER_LOW;
+  return POWER_NORMAL;
+}
+
+static void battery_handler(BatteryChargeState charge){
+  PowerLevel level = level_for(charge);
+  if(level == s_level)
+    return;
+  APP_LOG(APP_LOG_LEVEL_INFO, "power level %d at %d%%", level, charge.charge_percent);
+  s_level = level;
+  if(s_handler)
+    s_handler(level);
+}
+
+PowerLevel power_update(void){
+  s_level = level_for(battery_state_service_peek());
+  return s_level;
+}
+
+const PowerProfile *power_profile(void){
+  return &PROFILES[s_level];
+}
+
+void power_subscribe(PowerChangedHandler handler){
+  s_handler = handler;
+  battery_state_service_subscribe(battery_handler);
+}
+
+void power_unsubscribe(void){
+  battery_state_service_unsubscribe();
+  s_handler = NULL;
+}
\ No newline at end of file
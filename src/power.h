@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pebble.h>
+
+// Battery thresholds in percent. At or below LOW the session runs a cheaper
+// profile, at or below CRITICAL it also swaps the compass for the accelerometer.
+#ifndef POWER_LOW_PERCENT
+#define POWER_LOW_PERCENT 20
+#endif
+#ifndef POWER_CRITICAL_PERCENT
+#define POWER_CRITICAL_PERCENT 10
+#endif
+// Heading filter in degrees for the cheaper profiles
+#ifndef POWER_HEADING_FILTER_DEG
+#define POWER_HEADING_FILTER_DEG 15
+#endif
+
+typedef enum PowerLevel{
+  POWER_NORMAL=0,
+  POWER_LOW=1,
+  POWER_CRITICAL=2,
+  NUM_POWER_LEVELS
+}PowerLevel;
+
+typedef struct PowerProfile{
+  uint16_t vibe_on_ms;        // vibration pulse, each pulse plus pause lasts 2 s
+  uint16_t vibe_off_ms;
+  uint8_t heading_filter_deg;
+  uint16_t frame_ms;          // minimum time between spin redraws, 0 redraws on every change
+  bool backlight;
+  bool force_accel;
+}PowerProfile;
+
+typedef void (*PowerChangedHandler)(PowerLevel level);
+
+// Re-reads the battery state
+PowerLevel power_update(void);
+const PowerProfile *power_profile(void);
+
+void power_subscribe(PowerChangedHandler handler);
+void power_unsubscribe(void);
\ No newline at end of file
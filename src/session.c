@@ -0,0 +1,113 @@
+#include "session.h"
+#include "clock_ms.h"
+
+typedef struct SessionTransition{
+  uint8_t from;
+  uint8_t event;
+  uint8_t to;
+  uint16_t effects;
+}SessionTransition;
+
+#define START_ALARM (SESSION_SHOW_WINDOW | SESSION_SUBSCRIBE | SESSION_LIGHT | SESSION_VIBE_START | \
+                     SESSION_ARM_TIMER | SESSION_RESET_SPIN | SESSION_SPIN_TEXT | SESSION_TAP_SUBSCRIBE)
+#define START_TUTORIAL (SESSION_SHOW_WINDOW | SESSION_SUBSCRIBE | SESSION_RESET_SPIN | SESSION_SPIN_TEXT)
+#define RESTART_ALARM (SESSION_LIGHT | SESSION_VIBE_START | SESSION_ARM_TIMER | SESSION_RESET_SPIN | \
+                       SESSION_SPIN_TEXT | SESSION_REDRAW | SESSION_TAP_SUBSCRIBE)
+#define END_SESSION (SESSION_CANCEL_TIMER | SESSION_VIBE_STOP | SESSION_UNSUBSCRIBE | SESSION_HIDE_WINDOW | \
+                     SESSION_RESET_SPIN | SESSION_TAP_UNSUBSCRIBE)
+
+static const SessionTransition TRANSITIONS[] = {
+  { SESSION_IDLE,      SESSION_EVENT_ALARM,    SESSION_RINGING,   START_ALARM },
+  { SESSION_DISMISSED, SESSION_EVENT_ALARM,    SESSION_RINGING,   START_ALARM },
+  { SESSION_SNOOZED,   SESSION_EVENT_ALARM,    SESSION_RINGING,   START_ALARM },
+#if FEATURE_TUTORIAL
+  { SESSION_IDLE,      SESSION_EVENT_TUTORIAL, SESSION_RINGING,   START_TUTORIAL },
+  { SESSION_DISMISSED, SESSION_EVENT_TUTORIAL, SESSION_RINGING,   START_TUTORIAL },
+  { SESSION_SNOOZED,   SESSION_EVENT_TUTORIAL, SESSION_RINGING,   START_TUTORIAL },
+#endif
+  // Another alarm while one is up starts over, the window and sensor are already there.
+  // Gestures may not be, the session could have started as the tutorial
+  { SESSION_RINGING,   SESSION_EVENT_ALARM,    SESSION_RINGING,   SESSION_LIGHT | SESSION_VIBE_START | SESSION_ARM_TIMER |
+                                                                  SESSION_TAP_SUBSCRIBE },
+  { SESSION_HOLDING,   SESSION_EVENT_ALARM,    SESSION_RINGING,   RESTART_ALARM },
+  { SESSION_SPINNING,  SESSION_EVENT_ALARM,    SESSION_RINGING,   RESTART_ALARM },
+
+  { SESSION_RINGING,   SESSION_EVENT_HOLD,     SESSION_HOLDING,   SESSION_REDRAW },
+  { SESSION_HOLDING,   SESSION_EVENT_RELEASE,  SESSION_RINGING,   SESSION_REDRAW },
+  { SESSION_SPINNING,  SESSION_EVENT_RELEASE,  SESSION_RINGING,   SESSION_RESET_SPIN | SESSION_SPIN_TEXT | SESSION_REDRAW },
+  { SESSION_HOLDING,   SESSION_EVENT_MOVE,     SESSION_SPINNING,  SESSION_SPIN_TEXT | SESSION_REDRAW },
+  { SESSION_SPINNING,  SESSION_EVENT_MOVE,     SESSION_SPINNING,  SESSION_SPIN_TEXT | SESSION_REDRAW },
+  { SESSION_HOLDING,   SESSION_EVENT_SPUN,     SESSION_DISMISSED, END_SESSION },
+  { SESSION_SPINNING,  SESSION_EVENT_SPUN,     SESSION_DISMISSED, END_SESSION },
+
+  { SESSION_RINGING,   SESSION_EVENT_SNOOZE,   SESSION_SNOOZED,   SESSION_SCHEDULE_SNOOZE | END_SESSION },
+  { SESSION_HOLDING,   SESSION_EVENT_SNOOZE,   SESSION_SNOOZED,   SESSION_SCHEDULE_SNOOZE | END_SESSION },
+  { SESSION_SPINNING,  SESSION_EVENT_SNOOZE,   SESSION_SNOOZED,   SESSION_SCHEDULE_SNOOZE | END_SESSION },
+#if FEATURE_TUTORIAL
+  { SESSION_RINGING,   SESSION_EVENT_LEAVE,    SESSION_IDLE,      END_SESSION },
+  { SESSION_HOLDING,   SESSION_EVENT_LEAVE,    SESSION_IDLE,      END_SESSION },
+  { SESSION_SPINNING,  SESSION_EVENT_LEAVE,    SESSION_IDLE,      END_SESSION },
+#endif
+};
+
+static SessionState s_state = SESSION_IDLE;
+
+#if FEATURE_TRACE
+static SessionTraceEntry s_trace[SESSION_TRACE_LENGTH];
+static uint16_t s_trace_count;  // total records, ring index is count % SESSION_TRACE_LENGTH
+
+static void trace(SessionState from, uint8_t event, SessionState to, uint16_t effects){
+  SessionTraceEntry *entry = &s_trace[s_trace_count % SESSION_TRACE_LENGTH];
+  entry->states = from << 4 | to;
+  entry->event = event;
+  entry->effects = effects;
+  entry->ms = now_ms();
+  s_trace_count++;
+}
+#else
+#define trace(from, event, to, effects)
+#endif
+
+SessionState session_state(void){
+  return s_state;
+}
+
+uint16_t session_dispatch(SessionEvent event){
+  for(unsigned int i = 0; i < ARRAY_LENGTH(TRANSITIONS); i++) {
+    const SessionTransition *transition = &TRANSITIONS[i];
+    if(transition->from != s_state || transition->event != event)
+      continue;
+    trace(s_state, event, transition->to, transition->effects);
+    s_state = transition->to;
+    return transition->effects;
+  }
+  trace(s_state, event | SESSION_TRACE_IGNORED, s_state, 0);
+  return 0;
+}
+
+#if FEATURE_TRACE
+// Dump the trace ring oldest first as "SES <count> <offset> <hex>" lines of
+// LOG_CHUNK records each, decoded on the host by tools/session_decode.py
+#define LOG_CHUNK 8
+
+void session_trace_log(void){
+  static const char hex[] = "0123456789abcdef";
+  char buffer[LOG_CHUNK * sizeof(SessionTraceEntry) * 2 + 1];
+  uint16_t n = s_trace_count < SESSION_TRACE_LENGTH ? s_trace_count : SESSION_TRACE_LENGTH;
+  uint16_t first = s_trace_count - n;
+  
+  for(int offset = 0; offset < n; offset += LOG_CHUNK) {
+    int len = 0;
+    for(int i = offset; i < n && i < offset + LOG_CHUNK; i++) {
+      SessionTraceEntry *entry = &s_trace[(first + i) % SESSION_TRACE_LENGTH];
+      uint32_t words[2] = { entry->states << 24 | entry->event << 16 | entry->effects, entry->ms };
+      for(int w = 0; w < 2; w++) {
+        for(int shift = 28; shift >= 0; shift -= 4)
+          buffer[len++] = hex[(words[w] >> shift) & 0xf];
+      }
+    }
+    buffer[len] = '\0';
+    APP_LOG(APP_LOG_LEVEL_INFO, "SES %d %d %s", (int)s_trace_count, offset, buffer);
+  }
+}
+#endif
\ No newline at end of file
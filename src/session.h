@@ -0,0 +1,65 @@
+#pragma once
+
+#include <pebble.h>
+#include "feature_switches.h"
+
+// Alarm session state machine. Every transition declares the work it causes,
+// wakeup.c carries out exactly those effects and nothing else.
+typedef enum SessionState{
+  SESSION_IDLE=0,
+  SESSION_RINGING=1,    // spin window up, waiting for a hold
+  SESSION_HOLDING=2,    // button held, no movement yet
+  SESSION_SPINNING=3,
+  SESSION_DISMISSED=4,
+  SESSION_SNOOZED=5,
+  NUM_SESSION_STATES
+}SessionState;
+
+typedef enum SessionEvent{
+  SESSION_EVENT_ALARM=0,      // a wakeup fired
+  SESSION_EVENT_TUTORIAL=1,   // opened from the settings, no alarm behind it
+  SESSION_EVENT_HOLD=2,
+  SESSION_EVENT_RELEASE=3,
+  SESSION_EVENT_MOVE=4,       // spin angle moved
+  SESSION_EVENT_SPUN=5,       // MAX_SPINS reached
+  SESSION_EVENT_SNOOZE=6,
+  SESSION_EVENT_LEAVE=7,      // back out of the tutorial
+  NUM_SESSION_EVENTS
+}SessionEvent;
+
+// Effects of a transition, applied in this order
+#define SESSION_SHOW_WINDOW   (1 << 0)
+#define SESSION_SUBSCRIBE     (1 << 1)
+#define SESSION_LIGHT         (1 << 2)
+#define SESSION_VIBE_START    (1 << 3)
+#define SESSION_ARM_TIMER     (1 << 4)
+#define SESSION_RESET_SPIN    (1 << 5)
+#define SESSION_SPIN_TEXT     (1 << 6)
+#define SESSION_REDRAW        (1 << 7)
+#define SESSION_SCHEDULE_SNOOZE (1 << 8)
+#define SESSION_CANCEL_TIMER  (1 << 9)
+#define SESSION_VIBE_STOP     (1 << 10)
+#define SESSION_UNSUBSCRIBE   (1 << 11)
+#define SESSION_HIDE_WINDOW   (1 << 12)
+#define SESSION_TAP_SUBSCRIBE (1 << 13)
+#define SESSION_TAP_UNSUBSCRIBE (1 << 14)
+
+// Transition trace for the host, one 8 byte record per event
+#define SESSION_TRACE_LENGTH 32
+#define SESSION_TRACE_IGNORED 0x80  // set in the event byte when no transition matched
+
+typedef struct SessionTraceEntry{
+  uint8_t states;     // from << 4 | to
+  uint8_t event;
+  uint16_t effects;
+  uint32_t ms;
+}SessionTraceEntry;
+
+SessionState session_state(void);
+// Moves to the next state and returns the effects to apply, 0 if the event does not apply
+uint16_t session_dispatch(SessionEvent event);
+#if FEATURE_TRACE
+void session_trace_log(void);
+#else
+static inline void session_trace_log(void){}
+#endif
\ No newline at end of file
@@ -3,101 +3,346 @@
 #include "wakeup.h"
 #include "edit.h"
 #include "storage.h"
+#include "spin.h"
+#include "latency.h"
+#include "session.h"
+#include "format.h"
   
 #define SETTINGS_IS_ENABLED_KEY 5
+// Enough entries to cover the rows visible on screen at once
+#define ROW_CACHE_SIZE 6
 
 static Window *s_settings_window;
 static MenuLayer *s_settings_menu_layer;
-static struct Alarm *s_alarm;
-  
+
+// The latency row shows the history and dumps it and the session trace
+#define HAS_LATENCY_ROW (FEATURE_HISTORY || FEATURE_TRACE)
+
+// Fixed rows, listed after the alarms
 enum MENU_ITEM
 {
-  MENU_EDIT=0,
-  MENU_ENABLE_DISABLE=1,
-  MENU_TUTORIAL=2,
+  MENU_ADD,
+#if FEATURE_TUTORIAL
+  MENU_TUTORIAL,
+#endif
+  MENU_SNOOZE,
+  MENU_AUTO_SNOOZE,
+  MENU_FLIP_TO_SNOOZE,
+  MENU_ENGINE,
+#if HAS_LATENCY_ROW
+  MENU_LATENCY,
+#endif
   NUM_MENU
 };
 
+// Alarm rows show a time, setting rows their title, the longest is "Auto Snooze"
+#define ROW_TITLE_LENGTH sizeof("Auto Snooze")
+#define ROW_TEXT_LENGTH (FORMAT_TIME_LENGTH > ROW_TITLE_LENGTH ? FORMAT_TIME_LENGTH : ROW_TITLE_LENGTH)
+
+// Pre-formatted title and state of a row, filled on the first draw after a change
+typedef struct RowCache{
+  int16_t row;
+  char text[ROW_TEXT_LENGTH];
+  char state[8];
+}RowCache;
+
+static RowCache s_row_cache[ROW_CACHE_SIZE];
+// Header text, recomputed once after the alarms change and never while drawing
+static char s_header_text[sizeof("Alarm: ") - 1 + FORMAT_TIME_LENGTH];
+static int s_header_scheduled;
+// Clock style the cached times were formatted with
+static bool s_cache_24h;
+#if FEATURE_HISTORY
+static LatencyKind s_latency_kind;
+#endif
+
+// Snooze lengths offered in the menu, 0 turns snoozing off
+static const int SNOOZE_MINUTES[] = { 0, 5, DEFAULT_SNOOZE_MINUTES, 15 };
+static uint8_t s_row_cache_next;
+
+// Working copy handed to the edit window
+static Alarm s_edit_alarm;
+static int s_edit_index;
+
 void settings_window_show(){
   // Show the Window on the watch, with animated=true
   window_stack_push(s_settings_window, true);
 }
 
+static void format_alarm_time(char *buffer, size_t size, Alarm *alarm){
+  format_time(buffer, buffer + size, alarm->hour, alarm->minute, s_cache_24h);
+}
+
+static void row_cache_invalidate(int16_t row){
+  for(int i = 0; i < ROW_CACHE_SIZE; i++) {
+    if(row < 0 || s_row_cache[i].row == row)
+      s_row_cache[i].row = -1;
+  }
+}
+
+static void header_update(){
+  // What will fire next with the alarms as they are now, the wakeup itself is only set on exit
+  char *end = s_header_text + sizeof(s_header_text);
+  time_t timestamp;
+  
+  s_header_scheduled = storage_get_scheduled();
+  if(alarm_next(&timestamp) < 0) {
+    format_str(s_header_text, end, "No Alarm Set");
+  } else {
+    struct tm *t = localtime(&timestamp);
+    format_time(format_str(s_header_text, end, "Alarm: "), end, t->tm_hour, t->tm_min, s_cache_24h);
+  }
+}
+
+// An alarm changed: its row and the next fire time in the header
+static void alarm_changed(int16_t row){
+  row_cache_invalidate(row);
+  header_update();
+  layer_mark_dirty((Layer *)s_settings_menu_layer);
+}
+
+// A setting changed: only its own row
+static void setting_changed(int16_t row){
+  row_cache_invalidate(row);
+  layer_mark_dirty((Layer *)s_settings_menu_layer);
+}
+
+static void row_cache_fill(RowCache *entry, int16_t row){
+  int count = storage_alarm_count();
+  char *state_end = entry->state + sizeof(entry->state);
+  const char *text = "";
+  
+  entry->row = row;
+  entry->state[0] = '\0';
+  if(row < count) {
+    Alarm *alarm = storage_get_alarm(row);
+    format_alarm_time(entry->text, sizeof(entry->text), alarm);
+    format_str(entry->state, state_end, alarm->enabled ? "On" : "Off");
+    return;
+  }
+  
+  switch (row - count) {
+    case MENU_ADD:
+      text = "Add Alarm";
+      break;
+#if FEATURE_TUTORIAL
+    case MENU_TUTORIAL:
+      text = "Tutorial";
+      break;
+#endif
+    case MENU_SNOOZE: {
+      int minutes = load_persistent_storage_int(SNOOZE_KEY, DEFAULT_SNOOZE_MINUTES);
+      text = "Snooze";
+      if(minutes > 0)
+        format_str(format_int(entry->state, state_end, minutes), state_end, " min");
+      else
+        format_str(entry->state, state_end, "Off");
+      break;
+    }
+    case MENU_AUTO_SNOOZE:
+      text = "Auto Snooze";
+      format_str(entry->state, state_end, load_persistent_storage_bool(AUTO_SNOOZE_KEY, false) ? "On" : "Off");
+      break;
+    case MENU_FLIP_TO_SNOOZE:
+      text = "Flip Snooze";
+      format_str(entry->state, state_end, load_persistent_storage_bool(FLIP_TO_SNOOZE_KEY, false) ? "On" : "Off");
+      break;
+    case MENU_ENGINE:
+      text = "Sensor";
+      format_str(entry->state, state_end,
+                 load_persistent_storage_int(SPIN_ENGINE_KEY, SPIN_ENGINE_DEFAULT) == SPIN_ENGINE_ACCEL ? "Motion" : "Compass");
+      break;
+  }
+  format_str(entry->text, entry->text + sizeof(entry->text), text);
+}
+
+static RowCache *row_cache_get(int16_t row){
+  for(int i = 0; i < ROW_CACHE_SIZE; i++) {
+    if(s_row_cache[i].row == row)
+      return &s_row_cache[i];
+  }
+  
+  // Miss: format the row into the oldest entry
+  RowCache *entry = &s_row_cache[s_row_cache_next];
+  s_row_cache_next = (s_row_cache_next + 1) % ROW_CACHE_SIZE;
+  row_cache_fill(entry, row);
+  return entry;
+}
+
+static void settings_edit_saved(Alarm *alarm){
+  if(s_edit_index == storage_alarm_count()) {
+    // The fixed rows move down by one
+    storage_add_alarm(alarm);
+    row_cache_invalidate(-1);
+    header_update();
+    menu_layer_reload_data(s_settings_menu_layer);
+  } else {
+    // Only the user's fields come from the edit copy. A wakeup that fired while
+    // the editor was open may have rescheduled, its id is the stored one
+    Alarm stored = *storage_get_alarm(s_edit_index);
+    stored.hour = alarm->hour;
+    stored.minute = alarm->minute;
+    stored.enabled = alarm->enabled;
+    storage_set_alarm(s_edit_index, &stored);
+    alarm_changed(s_edit_index);
+  }
+}
+
 static uint16_t settings_num_sections(struct MenuLayer* menu, void* callback_context) {
   return 1;
 }
 
 static void settings_select(struct MenuLayer *s_menu_layer, MenuIndex *cell_index, void *callback_context) {
-  switch (cell_index->row) {
-    case MENU_ENABLE_DISABLE:
-      s_alarm->enabled = !s_alarm->enabled;
-      layer_mark_dirty((Layer *)s_settings_menu_layer);
+  int count = storage_alarm_count();
+  
+  if(cell_index->row < count) {
+    s_edit_index = cell_index->row;
+    s_edit_alarm = *storage_get_alarm(s_edit_index);
+    win_edit_show(&s_edit_alarm, settings_edit_saved);
+    return;
+  }
+  
+  switch (cell_index->row - count) {
+    case MENU_ADD:
+      if(count >= MAX_ALARMS)
+        break;
+      s_edit_index = count;
+      s_edit_alarm = (Alarm){ .hour = 0, .minute = 0, .enabled = true, .alarm_id = -1 };
+      win_edit_show(&s_edit_alarm, settings_edit_saved);
       break;
+#if FEATURE_TUTORIAL
     case MENU_TUTORIAL:
-      spin_window_show();
+      spin_tutorial_show();
       break;
-    case MENU_EDIT:
-      win_edit_show(s_alarm);
+#endif
+    case MENU_SNOOZE: {
+      int minutes = load_persistent_storage_int(SNOOZE_KEY, DEFAULT_SNOOZE_MINUTES);
+      int next = 0;
+      for(unsigned int i = 0; i < ARRAY_LENGTH(SNOOZE_MINUTES); i++) {
+        if(SNOOZE_MINUTES[i] == minutes)
+          next = (i + 1) % ARRAY_LENGTH(SNOOZE_MINUTES);
+      }
+      persist_write_int(SNOOZE_KEY, SNOOZE_MINUTES[next]);
+      setting_changed(cell_index->row);
+      break;
+    }
+    case MENU_AUTO_SNOOZE:
+      persist_write_bool(AUTO_SNOOZE_KEY, !load_persistent_storage_bool(AUTO_SNOOZE_KEY, false));
+      setting_changed(cell_index->row);
+      break;
+    case MENU_FLIP_TO_SNOOZE:
+      persist_write_bool(FLIP_TO_SNOOZE_KEY, !load_persistent_storage_bool(FLIP_TO_SNOOZE_KEY, false));
+      setting_changed(cell_index->row);
+      break;
+    case MENU_ENGINE:
+      persist_write_int(SPIN_ENGINE_KEY, (load_persistent_storage_int(SPIN_ENGINE_KEY, SPIN_ENGINE_DEFAULT) + 1) % NUM_SPIN_ENGINES);
+      setting_changed(cell_index->row);
+      break;
+#if HAS_LATENCY_ROW
+    case MENU_LATENCY:
+      // Cycle through the interaction types and dump the raw samples for the host
+#if FEATURE_HISTORY
+      s_latency_kind = (s_latency_kind + 1) % NUM_LATENCY_KINDS;
+      latency_log();
+#endif
+      session_trace_log();
+      layer_mark_dirty((Layer *)s_settings_menu_layer);
       break;
+#endif
   }
 }
 
+static void settings_select_long(struct MenuLayer *s_menu_layer, MenuIndex *cell_index, void *callback_context) {
+  if(cell_index->row >= storage_alarm_count())
+    return;
+  
+  // Toggle the alarm on or off
+  Alarm alarm = *storage_get_alarm(cell_index->row);
+  alarm.enabled = !alarm.enabled;
+  storage_set_alarm(cell_index->row, &alarm);
+  alarm_changed(cell_index->row);
+}
+
 static uint16_t settings_num_rows (struct MenuLayer *menulayer, uint16_t section_index, void *callback_context) {
-  return NUM_MENU;
+  return storage_alarm_count() + NUM_MENU;
 }
 
+#if HAS_LATENCY_ROW
+static void settings_draw_latency(GContext *ctx, GSize size){
+#if FEATURE_HISTORY
+  static char s_buffer[48];
+  char *end = s_buffer + sizeof(s_buffer);
+  char *out;
+  LatencyStats stats;
+  
+  latency_get_stats(s_latency_kind, &stats);
+  out = format_str(s_buffer, end, latency_name(s_latency_kind));
+  out = format_str(out, end, " latency (");
+  out = format_int(out, end, stats.count);
+  format_str(out, end, ")");
+  graphics_draw_text(ctx, s_buffer,
+                     fonts_get_system_font(FONT_KEY_GOTHIC_18_BOLD),
+                     GRect(3, 0, size.w, size.h), GTextOverflowModeWordWrap,
+                     GTextAlignmentLeft, NULL);
+  out = format_int(s_buffer, end, stats.min);
+  out = format_str(out, end, "/");
+  out = format_int(out, end, stats.avg);
+  out = format_str(out, end, "/");
+  out = format_int(out, end, stats.max);
+  out = format_str(out, end, " p95 ");
+  out = format_int(out, end, stats.p95);
+  format_str(out, end, " ms");
+  graphics_draw_text(ctx, s_buffer,
+                     fonts_get_system_font(FONT_KEY_GOTHIC_18),
+                     GRect(3, 20, size.w, size.h), GTextOverflowModeWordWrap,
+                     GTextAlignmentLeft, NULL);
+#else
+  graphics_draw_text(ctx, "Dump trace",
+                     fonts_get_system_font(FONT_KEY_GOTHIC_24),
+                     GRect(3, 4, size.w, size.h), GTextOverflowModeWordWrap,
+                     GTextAlignmentLeft, NULL);
+#endif
+}
+#endif
+
 static void settings_draw_row(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index, void *callback_context) {
-  static char s_buffer[32];
+  int count = storage_alarm_count();
 
   graphics_context_set_text_color(ctx, GColorBlack);
   graphics_context_set_fill_color(ctx, GColorWhite);
   GSize size = layer_get_frame(cell_layer).size;
   graphics_fill_rect(ctx,GRect(0,0,size.w,size.h),0,GCornerNone);
   
-  
-  switch (cell_index->row) {
-      case MENU_EDIT:
-        snprintf(s_buffer, sizeof(s_buffer), "Edit");
-        break;
-      case MENU_ENABLE_DISABLE:
-        snprintf(s_buffer, sizeof(s_buffer), "Enable");
-        if (s_alarm->enabled){
-          snprintf(s_buffer, sizeof(s_buffer), "Disable"); 
-        }
-        break;
-      case MENU_TUTORIAL:
-        snprintf(s_buffer, sizeof(s_buffer), "Tutorial");
-        break;
-      default:
-        break;
+#if HAS_LATENCY_ROW
+  if(cell_index->row - count == MENU_LATENCY) {
+    settings_draw_latency(ctx, size);
+    return;
   }
+#endif
   
-  graphics_draw_text(ctx, s_buffer,
-                     fonts_get_system_font(FONT_KEY_GOTHIC_28),
-                     GRect(3, 0, size.w, size.h), GTextOverflowModeWordWrap,
+  RowCache *entry = row_cache_get(cell_index->row);
+  bool has_state = entry->state[0] != '\0';
+  
+  // Setting rows share their width with the state, so use a smaller title
+  bool is_setting = cell_index->row >= count && has_state;
+  graphics_draw_text(ctx, entry->text,
+                     fonts_get_system_font(is_setting ? FONT_KEY_GOTHIC_24 : FONT_KEY_GOTHIC_28),
+                     GRect(3, is_setting ? 4 : 0, size.w, size.h), GTextOverflowModeWordWrap,
                      GTextAlignmentLeft, NULL);
+  if(has_state) {
+    graphics_draw_text(ctx, entry->state,
+                       fonts_get_system_font(FONT_KEY_GOTHIC_18),
+                       GRect(0, 8, size.w - 5, size.h), GTextOverflowModeWordWrap,
+                       GTextAlignmentRight, NULL);
+  }
 }
 
 static void settings_draw_header(GContext* ctx, const Layer* cell_layer, uint16_t section_index, void* callback_context) {
-  static char s_buffer[32];
-  int hour;
-  bool is_am;
-  
   graphics_context_set_text_color(ctx, GColorBlack);
   graphics_context_set_fill_color(ctx, GColorWhite);
   graphics_fill_rect(ctx,GRect(0,1,144,14),0,GCornerNone);
   
-  if(s_alarm->alarm_id == -1) {
-    snprintf(s_buffer, sizeof(s_buffer), "No Alarm Set");     
-  } else if(clock_is_24h_style()){
-    snprintf(s_buffer, sizeof(s_buffer), "Alarm: %d:%02d", s_alarm->hour, s_alarm->minute); 
-  } else {
-    convert_24_to_12(s_alarm->hour, &hour, &is_am);
-    snprintf(s_buffer, sizeof(s_buffer), "Alarm: %d:%02d %s", hour, s_alarm->minute, is_am ? "AM" : "PM"); 
-
-  }
-  
-  graphics_draw_text(ctx, s_buffer,
+  graphics_draw_text(ctx, s_header_text,
                      fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD),
                      GRect(3, -2, 144 - 33, 14), GTextOverflowModeWordWrap,
                      GTextAlignmentLeft, NULL);
@@ -119,6 +364,7 @@ static void settings_window_load(Window *window){
     .get_num_rows = settings_num_rows,
     .draw_row = settings_draw_row,
     .select_click = settings_select,
+    .select_long_click = settings_select_long,
     .draw_header = settings_draw_header,
     .get_header_height = settings_header_height,
   });
@@ -127,13 +373,30 @@ static void settings_window_load(Window *window){
   menu_layer_set_click_config_onto_window(s_settings_menu_layer, window);
   
   layer_add_child(window_layer, menu_layer_get_layer(s_settings_menu_layer));
+  header_update();
+}
+
+static void settings_window_appear(Window *window){
+  // The edit window and the tutorial already invalidated what they changed,
+  // only a new clock style reformats every row
+  bool is_24h = clock_is_24h_style();
+  if(is_24h != s_cache_24h) {
+    s_cache_24h = is_24h;
+    row_cache_invalidate(-1);
+    header_update();
+  } else if(storage_get_scheduled() != s_header_scheduled) {
+    // An alarm rang while we were hidden and moved the schedule on
+    header_update();
+  }
 }
 
 static void settings_window_unload(Window *window){
+  menu_layer_destroy(s_settings_menu_layer);
 }
   
-void settings_window_init(struct Alarm *alarm){
-  s_alarm = alarm;
+void settings_window_init(void){
+  s_cache_24h = clock_is_24h_style();
+  row_cache_invalidate(-1);
   
   // Create settings Window element and assign to pointer
   s_settings_window = window_create();
@@ -145,6 +408,7 @@ void settings_window_init(struct Alarm *alarm){
   // Set handlers to manage the elements inside the Window
   window_set_window_handlers(s_settings_window, (WindowHandlers) {
     .load = settings_window_load,
+    .appear = settings_window_appear,
     .unload = settings_window_unload
   });
 }
\ No newline at end of file
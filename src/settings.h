@@ -3,5 +3,5 @@
 #include <pebble.h>
 #include "alarm.h"
   
-void settings_window_init(struct Alarm *alarm);
+void settings_window_init(void);
 void settings_window_show(void);
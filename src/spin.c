@@ -0,0 +1,34 @@
+#include "spin.h"
+
+static int32_t math_abs(int32_t n){
+  return n < 0 ? -n : n;
+}
+
+void spin_reset(SpinState *state){
+  state->angle = -1;
+  state->spins = 0;
+}
+
+// Feed a heading sample, returns true if the spin angle moved
+bool spin_update_tuned(SpinState *state, int32_t heading, const SpinTuning *tuning){
+  int32_t diff = math_abs(TRIGANGLE_TO_DEG(state->prev_heading - heading));
+  bool moved = diff > tuning->move_deg;
+  
+  if (state->prev_heading > heading && moved) {
+    // clockwise
+    state->angle -= tuning->step_deg * TRIG_MAX_ANGLE / 360;
+  } else if(moved) {
+    // counterclockwise
+    state->angle += tuning->step_deg * TRIG_MAX_ANGLE / 360;
+  }
+  state->prev_heading = heading;
+  
+  // Set the number of spins completed
+  state->spins = (int16_t)((math_abs(TRIGANGLE_TO_DEG(state->angle)) + tuning->slack_deg) / 180);
+  return moved;
+}
+
+bool spin_update(SpinState *state, int32_t heading){
+  static const SpinTuning tuning = SPIN_TUNING_DEFAULT;
+  return spin_update_tuned(state, heading, &tuning);
+}
\ No newline at end of file
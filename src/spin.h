@@ -0,0 +1,62 @@
+#pragma once
+
+#include <pebble.h>
+
+// Detector tuning, each can be overridden at build time (wscript --spin-tuning,
+// values picked with tools/autotune.c)
+
+// Half turns needed to dismiss
+#ifndef MAX_SPINS
+#define MAX_SPINS 2
+#endif
+// Heading change in degrees that counts as movement
+#ifndef SPIN_MOVE_DEG
+#define SPIN_MOVE_DEG 5
+#endif
+// Degrees the spin angle advances per movement
+#ifndef SPIN_STEP_DEG
+#define SPIN_STEP_DEG 10
+#endif
+// Degrees granted towards every half turn
+#ifndef SPIN_SLACK_DEG
+#define SPIN_SLACK_DEG 20
+#endif
+// Compass service heading filter in degrees
+#ifndef SPIN_HEADING_FILTER_DEG
+#define SPIN_HEADING_FILTER_DEG 5
+#endif
+// Button hold before spinning counts
+#ifndef SPIN_LONG_CLICK_MS
+#define SPIN_LONG_CLICK_MS 100
+#endif
+
+// Engines that can feed headings into the spin detector
+typedef enum SpinEngine{
+  SPIN_ENGINE_COMPASS=0,
+  SPIN_ENGINE_ACCEL=1,
+  NUM_SPIN_ENGINES
+}SpinEngine;
+
+#ifndef SPIN_ENGINE_DEFAULT
+#define SPIN_ENGINE_DEFAULT SPIN_ENGINE_COMPASS
+#endif
+
+typedef void (*SpinHeadingHandler)(int32_t heading);
+
+typedef struct SpinTuning{
+  int16_t move_deg;
+  int16_t step_deg;
+  int16_t slack_deg;
+}SpinTuning;
+
+#define SPIN_TUNING_DEFAULT { SPIN_MOVE_DEG, SPIN_STEP_DEG, SPIN_SLACK_DEG }
+
+typedef struct SpinState{
+  int32_t angle;
+  int32_t prev_heading;
+  int16_t spins;
+}SpinState;
+
+void spin_reset(SpinState *state);
+bool spin_update(SpinState *state, int32_t heading);
+bool spin_update_tuned(SpinState *state, int32_t heading, const SpinTuning *tuning);
\ No newline at end of file
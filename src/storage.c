@@ -1,27 +1,157 @@
 #include "storage.h"
 #include "alarm.h"
 
-void load_persistent_storage_alarm(Alarm *alarm)
+typedef struct AlarmIndex{
+  uint8_t count;
+  int8_t scheduled;
+}AlarmIndex;
+
+typedef struct AlarmPage{
+  int8_t page;
+  bool dirty;
+  Alarm alarms[ALARMS_PER_PAGE];
+}AlarmPage;
+
+static AlarmIndex s_index;
+static bool s_index_dirty;
+static AlarmPage s_pages[ALARM_PAGE_CACHE];
+static uint8_t s_next_victim;
+
+static void init_alarm(Alarm *alarm)
+{
+  alarm->hour=0;
+  alarm->minute=0;
+  alarm->enabled=false;
+  alarm->alarm_id=-1;
+}
+
+static void write_page(AlarmPage *page)
+{
+  if(page->page < 0 || !page->dirty)
+    return;
+  persist_write_data(ALARMS_PAGE_KEY + page->page, page->alarms, sizeof(page->alarms));
+  page->dirty = false;
+}
+
+static AlarmPage *load_page(int page_num)
+{
+  for(int i = 0; i < ALARM_PAGE_CACHE; i++) {
+    if(s_pages[i].page == page_num)
+      return &s_pages[i];
+  }
+
+  // Evict round-robin, writing back the victim if it was modified
+  AlarmPage *page = &s_pages[s_next_victim];
+  s_next_victim = (s_next_victim + 1) % ALARM_PAGE_CACHE;
+  write_page(page);
+
+  page->page = page_num;
+  page->dirty = false;
+  for(int i = 0; i < ALARMS_PER_PAGE; i++)
+    init_alarm(&page->alarms[i]);
+  if(persist_exists(ALARMS_PAGE_KEY + page_num))
+    persist_read_data(ALARMS_PAGE_KEY + page_num, page->alarms, sizeof(page->alarms));
+  return page;
+}
+
+static void migrate_legacy_alarm()
+{
+  Alarm alarm;
+  DEBUG_LOG("migrating legacy alarm");
+  persist_read_data(ALARMS_KEY, &alarm, sizeof(Alarm));
+  storage_add_alarm(&alarm);
+  s_index.scheduled = alarm.alarm_id == -1 ? -1 : 0;
+  storage_flush();
+  persist_delete(ALARMS_KEY);
+}
+
+void storage_init(void)
 {
+  for(int i = 0; i < ALARM_PAGE_CACHE; i++) {
+    s_pages[i].page = -1;
+    s_pages[i].dirty = false;
+  }
+  s_next_victim = 0;
+  s_index_dirty = false;
+
+  if(persist_exists(ALARMS_INDEX_KEY))
+  {
+    persist_read_data(ALARMS_INDEX_KEY, &s_index, sizeof(AlarmIndex));
+    if(s_index.count > MAX_ALARMS)
+      s_index.count = MAX_ALARMS;
+  }
+  else
+  {
+    s_index.count = 0;
+    s_index.scheduled = -1;
     if(persist_exists(ALARMS_KEY))
-    {
-      APP_LOG(APP_LOG_LEVEL_DEBUG, "alarm stored");
-      persist_read_data(ALARMS_KEY,alarm,sizeof(struct Alarm));
-      APP_LOG(APP_LOG_LEVEL_DEBUG, "alarm stored end");
-    }
-    else
-    {
-        APP_LOG(APP_LOG_LEVEL_DEBUG, "alarm new");
-        alarm->hour=0;
-        alarm->minute=0;
-        alarm->enabled=false;
-        alarm->alarm_id=-1;
-    }
+      migrate_legacy_alarm();
+  }
+}
+
+void storage_flush(void)
+{
+  for(int i = 0; i < ALARM_PAGE_CACHE; i++)
+    write_page(&s_pages[i]);
+  if(s_index_dirty) {
+    persist_write_data(ALARMS_INDEX_KEY, &s_index, sizeof(AlarmIndex));
+    s_index_dirty = false;
+  }
+}
+
+void storage_deinit(void)
+{
+  storage_flush();
+}
+
+int storage_alarm_count(void)
+{
+  return s_index.count;
+}
+
+Alarm *storage_get_alarm(int index)
+{
+  if(index < 0 || index >= s_index.count)
+    return NULL;
+  AlarmPage *page = load_page(index / ALARMS_PER_PAGE);
+  return &page->alarms[index % ALARMS_PER_PAGE];
 }
 
-void write_persistent_storage_alarm(Alarm *alarm)
+void storage_set_alarm(int index, Alarm *alarm)
 {
-  persist_write_data(ALARMS_KEY,alarm,8*sizeof(Alarm));
+  if(index < 0 || index >= s_index.count)
+    return;
+  AlarmPage *page = load_page(index / ALARMS_PER_PAGE);
+  Alarm *slot = &page->alarms[index % ALARMS_PER_PAGE];
+  if(memcmp(slot, alarm, sizeof(Alarm)) == 0)
+    return;
+  memcpy(slot, alarm, sizeof(Alarm));
+  page->dirty = true;
+}
+
+int storage_add_alarm(Alarm *alarm)
+{
+  if(s_index.count >= MAX_ALARMS)
+    return -1;
+  int index = s_index.count++;
+  s_index_dirty = true;
+  AlarmPage *page = load_page(index / ALARMS_PER_PAGE);
+  memcpy(&page->alarms[index % ALARMS_PER_PAGE], alarm, sizeof(Alarm));
+  page->dirty = true;
+  return index;
+}
+
+int storage_get_scheduled(void)
+{
+  return s_index.scheduled;
+}
+
+void storage_set_scheduled(int index)
+{
+  if(s_index.scheduled == index)
+    return;
+  s_index.scheduled = index;
+  s_index_dirty = true;
 }
 
 bool load_persistent_storage_bool(int key, bool default_val)
@@ -35,6 +165,6 @@ int load_persistent_storage_int(int key, int default_val)
 {
   int temp = default_val;
   if(persist_exists(key))
-    temp = persist_read_bool(key);
+    temp = persist_read_int(key);
   return temp;
 }
\ No newline at end of file
@@ -10,10 +10,29 @@
 #define VIBRATION_DURATION_KEY 9
 #define AUTO_SNOOZE_KEY 10
 #define BACKGROUND_TRACKING_KEY 11
-#define ALARMS_KEY 12
+#define ALARMS_KEY 12 // legacy single-alarm blob, migrated on first load
+#define ALARMS_INDEX_KEY 13
+#define SPIN_ENGINE_KEY 14
+#define ALARMS_PAGE_KEY 32 // pages live in ALARMS_PAGE_KEY .. ALARMS_PAGE_KEY + ALARM_PAGES - 1
+
+// Alarms are persisted in fixed-size pages, each well below PERSIST_DATA_MAX_LENGTH.
+// Only ALARM_PAGE_CACHE pages are held in RAM at any time.
+#define ALARMS_PER_PAGE 8
+#define ALARM_PAGES (MAX_ALARMS / ALARMS_PER_PAGE)
+#define ALARM_PAGE_CACHE 2
+
+void storage_init(void);
+void storage_deinit(void);
+void storage_flush(void);
+
+int storage_alarm_count(void);
+// Returned pointer is only valid until the next storage call that loads another page.
+Alarm *storage_get_alarm(int index);
+void storage_set_alarm(int index, Alarm *alarm);
+int storage_add_alarm(Alarm *alarm);
+
+int storage_get_scheduled(void);
+void storage_set_scheduled(int index);
 
-void load_persistent_storage_alarm(Alarm *alarm);
 bool load_persistent_storage_bool(int key, bool default_val);
 int load_persistent_storage_int(int key, int default_val);
-
-void write_persistent_storage_alarm(Alarm *alarm);
@@ -3,41 +3,49 @@
 #include "main.h"
 #include "settings.h"
 #include "edit.h"
-
-#define TESTING false
-  
-static Alarm *s_alarm;
+#include "storage.h"
+#include "spin.h"
+#include "accel.h"
+#include "latency.h"
+#include "session.h"
+#include "format.h"
+#include "feature_switches.h"
+#include "power.h"
+#include "clock_ms.h"
+
+  
+static int s_alarm_index = -1;
 static bool *s_snooze;
+static AppTimer *s_auto_snooze_timer;
+static int s_snooze_minutes;
 
-// vibrate for 1 min.
-static const uint32_t segments[] = { 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
-                                     1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
-                                     1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
-                                     1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
-                                     1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
-                                     1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000 };
-
-VibePattern vibe_pat = {
-  .durations = segments,
-  .num_segments = ARRAY_LENGTH(segments),
-};
+// vibrate for 1 min. in pulses shaped by the power profile
+#define VIBE_SEGMENTS 60
+static uint32_t s_vibe_segments[VIBE_SEGMENTS];
+
+// Auto snooze kicks in once the vibration pattern has run out
+#define AUTO_SNOOZE_MS (60 * 1000)
+
+// Spin redraws are rate limited on a low battery
+static AppTimer *s_frame_timer;
+static uint32_t s_last_frame_ms;
 
 // Spin constants
 static const int16_t RADIUS = 58;
 static const int16_t BORDER = 8;
-static const int16_t MAX_SPINS = 2;
   
 // Spin window
 static Window *s_spin_window;
 
-// Spin Layers
-static TextLayer *s_spin_time_layer, *s_spin_heading_text_layer, *s_spin_top_text_layer, *s_spin_spins_text_layer, *s_spin_bottom_text_layer;
-static Layer *s_spin_circle_canvas_layer;
-static Layer *s_spin_triangle_canvas_layer;
+// Spin Layer, one canvas draws the welcome screen, the spin dial and all text
+static Layer *s_spin_canvas_layer;
 
-// Spin welcome Layers
-static TextLayer *s_welcome_text_layer;
-static Layer *s_welcome_canvas_layer;
+// Spin fonts, looked up once on load
+static GFont s_font_small, s_font_medium, s_font_large;
+
+// Spin text
+static char s_spins_buffer[8];
+static int16_t s_spins_drawn = -1;
 
 // Spin paths and points
 static GPoint s_center, s_spin_circle_center;
@@ -62,89 +70,72 @@ static GRect s_welcome_rect;
 //   .points = (GPoint []) {{0, 0}, {0, -20}, {20, -10}}
 // };
 
-// Spin state stuff
-static int32_t angle = -1;
-static int32_t prev_compass_heading = 0;
-static bool s_spinning = false;
-static int16_t spins = 0;
-
-int32_t math_abs(int32_t n){
-  return n < 0 ? -n : n;
-}
+// Sensor warm-up, started as early as possible so a heading is ready for the first hold
+typedef enum SensorState{
+  SENSOR_COLD,
+  SENSOR_CALIBRATING,
+  SENSOR_READY
+}SensorState;
+
+static const char *SENSOR_HINTS[] = {
+  [SENSOR_COLD] = "Compass warming up",
+  [SENSOR_CALIBRATING] = "Compass calibrating",
+  [SENSOR_READY] = "",
+};
 
-static void spin_set_hidden(bool hidden){
-  layer_set_hidden((Layer *)s_spin_heading_text_layer, hidden);
-  layer_set_hidden((Layer *)s_spin_top_text_layer, hidden);
-  layer_set_hidden((Layer *)s_spin_spins_text_layer, hidden);
-  layer_set_hidden((Layer *)s_spin_bottom_text_layer, hidden);
+// Spin state stuff
+static SpinState s_spin;
+static SpinEngine s_engine;
+static SensorState s_sensor_state = SENSOR_COLD;
+static bool s_engine_subscribed = false;
+
+static bool is_holding(){
+  SessionState state = session_state();
+  return state == SESSION_HOLDING || state == SESSION_SPINNING;
 }
 
-static void set_spinning(bool spinning){
-  s_spinning = spinning;
-  spin_set_hidden(!s_spinning);
-  if(!spinning) {
-    layer_mark_dirty(s_spin_triangle_canvas_layer);
-    layer_mark_dirty(s_spin_circle_canvas_layer);
-    angle = -1;
+static void set_spins_text(){
+  // Only re-format when the counter actually changed
+  if(s_spin.spins == s_spins_drawn) {
+    return;
   }
+  s_spins_drawn = s_spin.spins;
+  format_int(s_spins_buffer, s_spins_buffer + sizeof(s_spins_buffer), MAX_SPINS - s_spin.spins);
 }
 
-static void set_alarm_on(bool on){
-  if(!on){
-    // off state
-    vibes_cancel();
-    set_spinning(false);
-    window_stack_remove(s_spin_window, true);
+static void session_event(SessionEvent event);
+
+static void set_sensor_state(SensorState state){
+  if(state == s_sensor_state) {
     return;
-  } 
-  // on state
-  spins = 0;
-  set_spinning(false);
+  }
+  s_sensor_state = state;
+  // The hint is only drawn on the welcome screen
+  if(s_spin_canvas_layer && session_state() == SESSION_RINGING) {
+    layer_mark_dirty(s_spin_canvas_layer);
+  }
 }
 
 void set_spin_angle(int32_t compass_heading){
-  if(!s_spinning) {
+  if(!is_holding()) {
+    // Track the heading while idle so the first hold starts from a fresh baseline
+    s_spin.prev_heading = compass_heading;
     return;
   }
   
-  // Allocate a static output buffer
-  static char s_buffer[32];
-  static int32_t diff, deg;
-  
-  diff = math_abs(TRIGANGLE_TO_DEG(prev_compass_heading - compass_heading));
-  
-  if (TESTING){
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "prev compass heading: %d", (int)prev_compass_heading);
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "compass heading: %d", (int)compass_heading);
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "diff: %d", (int)diff);
-  }
-    
-  if (prev_compass_heading > compass_heading && diff > 5) {
-    angle -= 10 * TRIG_MAX_ANGLE / 360;
-    if(TESTING) APP_LOG(APP_LOG_LEVEL_DEBUG, "clockwise");
-  } else if(diff > 5) {
-    angle += 10 * TRIG_MAX_ANGLE / 360;
-    if(TESTING) APP_LOG(APP_LOG_LEVEL_DEBUG, "counterclockwise");
-  }
-  prev_compass_heading = compass_heading;
-  
-  // Set the number of spins completed
-  deg = TRIGANGLE_TO_DEG(angle);
-  spins = (int16_t)((math_abs(deg) + 20) / 180);
+  DEBUG_LOG("prev compass heading: %d", (int)s_spin.prev_heading);
+  DEBUG_LOG("compass heading: %d", (int)compass_heading);
   
-  // Turn off alarm
-  if (spins == MAX_SPINS) {
-    set_alarm_on(false);
+  if(!spin_update(&s_spin, compass_heading)) {
+    return;
   }
+  latency_start(LATENCY_SPIN);
   
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "deg: %d", (int)deg);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "spins: %d", (int)deg);
+  DEBUG_LOG("deg: %d", (int)TRIGANGLE_TO_DEG(s_spin.angle));
+  DEBUG_LOG("spins: %d", (int)s_spin.spins);
   
-  // Set spin text
-  snprintf(s_buffer, sizeof(s_buffer), "%d", MAX_SPINS - spins);
-  text_layer_set_text(s_spin_spins_text_layer, s_buffer);
-  
-  layer_mark_dirty(s_spin_triangle_canvas_layer);
+  // Turn off alarm once enough spins are done
+  session_event(s_spin.spins >= MAX_SPINS ? SESSION_EVENT_SPUN : SESSION_EVENT_MOVE);
 }
 
 // Compass callback
@@ -153,15 +144,18 @@ void compass_handler(CompassHeadingData data) {
   switch (data.compass_status) {
     // Compass data is not yet valid
     case CompassStatusDataInvalid:
-      APP_LOG(APP_LOG_LEVEL_ERROR, "Compass data invalid, got: %d", (int)TRIGANGLE_TO_DEG(data.true_heading));
+      DEBUG_LOG("Compass data invalid, got: %d", (int)TRIGANGLE_TO_DEG(data.true_heading));
+      set_sensor_state(SENSOR_COLD);
       break;
 
     // Compass is currently calibrating, but a heading is available
     case CompassStatusCalibrating:
+      set_sensor_state(SENSOR_CALIBRATING);
       set_spin_angle((int32_t)data.true_heading);
       break;
     // Compass data is ready for use, write the heading in to the buffer
     case CompassStatusCalibrated:
+      set_sensor_state(SENSOR_READY);
       set_spin_angle((int32_t)data.true_heading);
       break;
 
@@ -172,21 +166,112 @@ void compass_handler(CompassHeadingData data) {
   }
 }
 
-static void update_triangle_proc(Layer *layer, GContext *ctx) {
-  if(!s_spinning) {
+static SpinEngine spin_engine_for_profile(){
+  // The accelerometer is the cheaper sensor when the battery is nearly flat
+  if(power_profile()->force_accel) {
+    return SPIN_ENGINE_ACCEL;
+  }
+  return load_persistent_storage_int(SPIN_ENGINE_KEY, SPIN_ENGINE_DEFAULT);
+}
+
+static void spin_engine_subscribe(){
+  if(s_engine_subscribed) {
     return;
   }
+  s_engine_subscribed = true;
+  s_engine = spin_engine_for_profile();
   
+  if(s_engine == SPIN_ENGINE_ACCEL) {
+    // No warm-up needed, samples are usable straight away
+    set_sensor_state(SENSOR_READY);
+    accel_spin_subscribe(set_spin_angle);
+    return;
+  }
+  // Subscribe to the compass data service when angle changes by SPIN_HEADING_FILTER_DEG
+  set_sensor_state(SENSOR_COLD);
+  compass_service_subscribe(compass_handler);
+  compass_service_set_heading_filter(DEG_TO_TRIGANGLE(power_profile()->heading_filter_deg));
+}
+
+static void spin_engine_unsubscribe(){
+  if(!s_engine_subscribed) {
+    return;
+  }
+  s_engine_subscribed = false;
+  if(s_engine == SPIN_ENGINE_ACCEL) {
+    accel_spin_unsubscribe();
+  } else {
+    compass_service_unsubscribe();
+  }
+  set_sensor_state(SENSOR_COLD);
+}
+
+static void power_changed(PowerLevel level){
+  if(!s_engine_subscribed) {
+    return;
+  }
+  // Follow the new profile with the running sensor
+  if(spin_engine_for_profile() != s_engine) {
+    spin_engine_unsubscribe();
+    spin_engine_subscribe();
+    s_spin.prev_heading = 0;
+  } else if(s_engine == SPIN_ENGINE_COMPASS) {
+    compass_service_set_heading_filter(DEG_TO_TRIGANGLE(power_profile()->heading_filter_deg));
+  }
+}
+
+static void frame_callback(void *data){
+  s_frame_timer = NULL;
+  s_last_frame_ms = now_ms();
+  layer_mark_dirty(s_spin_canvas_layer);
+}
+
+static void cancel_frame(){
+  if(s_frame_timer) {
+    app_timer_cancel(s_frame_timer);
+    s_frame_timer = NULL;
+  }
+}
+
+static void redraw_spin(){
+  if(!s_spin_canvas_layer) {
+    return;
+  }
+  uint16_t frame_ms = power_profile()->frame_ms;
+  uint32_t elapsed = now_ms() - s_last_frame_ms;
+  
+  // Only the spin animation is throttled, state changes show straight away
+  if(frame_ms == 0 || session_state() != SESSION_SPINNING || elapsed >= frame_ms) {
+    cancel_frame();
+    s_last_frame_ms += elapsed;
+    layer_mark_dirty(s_spin_canvas_layer);
+  } else if(!s_frame_timer) {
+    s_frame_timer = app_timer_register(frame_ms - elapsed, frame_callback, NULL);
+  }
+}
+
+static void start_vibes(){
+  const PowerProfile *profile = power_profile();
+  for(int i = 0; i < VIBE_SEGMENTS; i++) {
+    s_vibe_segments[i] = i % 2 ? profile->vibe_off_ms : profile->vibe_on_ms;
+  }
+  vibes_cancel();
+  vibes_enqueue_custom_pattern((VibePattern) {
+    .durations = s_vibe_segments,
+    .num_segments = VIBE_SEGMENTS,
+  });
+}
+
+static void draw_triangle(GContext *ctx) {
   // Move
+  int32_t angle = s_spin.angle;
   int32_t move_x = (int32_t)(sin_lookup(angle) * (RADIUS - 4) / TRIG_MAX_RATIO);
   int32_t move_y = (int32_t)(-cos_lookup(angle) * (RADIUS - 4) / TRIG_MAX_RATIO);
   gpath_move_to(s_spin_arrow_path, GPoint(s_spin_circle_center.x - move_x, s_spin_circle_center.y + move_y));
   
-  if(TESTING){
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "move_x: %d", (int)move_x);
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "move_y: %d", (int)move_y);
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "angle: %d", (int)TRIGANGLE_TO_DEG(angle));
-  }
+  DEBUG_LOG("move_x: %d", (int)move_x);
+  DEBUG_LOG("move_y: %d", (int)move_y);
+  DEBUG_LOG("angle: %d", (int)TRIGANGLE_TO_DEG(angle));
   
   // Rotate
   gpath_rotate_to(s_spin_triangle_path, -angle);
@@ -199,20 +284,22 @@ static void update_triangle_proc(Layer *layer, GContext *ctx) {
   gpath_draw_filled(ctx, s_spin_arrow_path);
 }
 
-static void update_welcome_proc(Layer *layer, GContext *ctx){
+static void draw_welcome(GContext *ctx){
   // Fill the path:
   graphics_context_set_fill_color(ctx, GColorBlack);
   gpath_draw_filled(ctx, s_welcome_arrow_path);
   graphics_context_set_fill_color(ctx, GColorWhite);
   gpath_draw_filled(ctx, s_welcome_arrow_path);
   graphics_fill_rect(ctx, s_welcome_rect, 0, GCornerNone );
-
+  
+  graphics_draw_text(ctx, "Press and hold", s_font_medium, GRect(10, s_center.y - 12, 144, 50),
+                     GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+  // Sensor warm-up hint
+  graphics_draw_text(ctx, SENSOR_HINTS[s_sensor_state], s_font_small, GRect(10, s_center.y + 16, 100, 20),
+                     GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
 }
 
-static void update_spin_circle_proc(Layer *layer, GContext *ctx) {
-  if(!s_spinning){
-    return;
-  }
+static void draw_spin_circle(GContext *ctx) {
   graphics_context_set_stroke_color(ctx, GColorWhite);
   graphics_context_set_fill_color(ctx, GColorWhite);
   graphics_fill_circle(ctx, s_spin_circle_center, RADIUS + BORDER);
@@ -220,52 +307,209 @@ static void update_spin_circle_proc(Layer *layer, GContext *ctx) {
   graphics_fill_circle(ctx, s_spin_circle_center, RADIUS);
 }
 
-static void update_time() {
-  // Get a tm structure
-  time_t temp = time(NULL); 
-  struct tm *tick_time = localtime(&temp);
-
-  // Create a long-lived buffer
-  static char buffer[] = "00:00:00";
+static void draw_spin_text(GContext *ctx) {
+  int16_t y = s_spin_circle_center.y;
+  
+  graphics_draw_text(ctx, "To turn off alarm", s_font_small, GRect(0, 5, 144, 50),
+                     GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+  graphics_draw_text(ctx, "Spin Around", s_font_small, GRect(0, y - 30, 144, 50),
+                     GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+  graphics_draw_text(ctx, s_spins_buffer, s_font_large, GRect(0, y - 14, 144, 50),
+                     GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+  graphics_draw_text(ctx, "Times!", s_font_small, GRect(0, y + 34 - 14, 144, 50),
+                     GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
 
-  // Write the current hours and minutes into the buffer
-  if(clock_is_24h_style() == true) {
-    // Use 24 hour format
-    strftime(buffer, sizeof("00:00"), "%h:%M", tick_time);
-  } else {
-    // Use 12 hour format
-    strftime(buffer, sizeof("00:00 00"), "%I:%M %p", tick_time);
+static void update_spin_proc(Layer *layer, GContext *ctx) {
+  graphics_context_set_text_color(ctx, GColorWhite);
+  
+  if(!is_holding()) {
+    latency_stop(LATENCY_RELEASE);
+    draw_welcome(ctx);
+    return;
   }
+  latency_stop(LATENCY_HOLD);
+  latency_stop(LATENCY_SPIN);
   
-  // Remove the leading zero
-  if (buffer[0] == '0') {
-    memmove(&buffer[0], &buffer[1], sizeof(buffer) - 1);
+  draw_spin_circle(ctx);
+  draw_triangle(ctx);
+  draw_spin_text(ctx);
+}
+
+static void snooze(){
+  s_snooze_minutes = load_persistent_storage_int(SNOOZE_KEY, DEFAULT_SNOOZE_MINUTES);
+  if(s_alarm_index < 0 || s_snooze_minutes <= 0) {
+    return;
   }
+  session_event(SESSION_EVENT_SNOOZE);
+}
 
-  // Display this time on the TextLayer
-  text_layer_set_text(s_spin_time_layer, buffer);
+static void auto_snooze_callback(void *data){
+  s_auto_snooze_timer = NULL;
+  snooze();
 }
 
-static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  update_time();
+static void cancel_auto_snooze(){
+  if(s_auto_snooze_timer) {
+    app_timer_cancel(s_auto_snooze_timer);
+    s_auto_snooze_timer = NULL;
+  }
+}
+
+// ----------------- GESTURES -----------------
+
+// Every gesture is two taps within this window, a single bump never snoozes:
+// a flip is a Z tap followed by one in the opposite direction as the watch
+// turns back, a knock is two taps on the side
+#define DOUBLE_TAP_MS 1500
+
+static bool s_tap_subscribed = false;
+static bool s_tap_pending = false;
+static AccelAxisType s_tap_axis;
+static int32_t s_tap_direction;
+static uint32_t s_tap_ms;
+
+static bool tap_confirms(AccelAxisType axis, int32_t direction, uint32_t now){
+  if(!s_tap_pending || now - s_tap_ms > DOUBLE_TAP_MS) {
+    return false;
+  }
+  if(axis == ACCEL_AXIS_Z) {
+    return s_tap_axis == ACCEL_AXIS_Z && s_tap_direction != direction;
+  }
+  return s_tap_axis != ACCEL_AXIS_Z;
+}
+
+static void tap_handler(AccelAxisType axis, int32_t direction){
+  // Holding and spinning shake the wrist as well, only a waiting alarm reacts
+  if(session_state() != SESSION_RINGING) {
+    return;
+  }
+  uint32_t now = now_ms();
+  if(tap_confirms(axis, direction, now)) {
+    s_tap_pending = false;
+    snooze();
+    return;
+  }
+  s_tap_pending = true;
+  s_tap_axis = axis;
+  s_tap_direction = direction;
+  s_tap_ms = now;
+}
+
+static void tap_subscribe(){
+  // The tap service is interrupt driven, nothing is sampled until the hardware reports a tap
+  if(s_tap_subscribed || !load_persistent_storage_bool(FLIP_TO_SNOOZE_KEY, false)) {
+    return;
+  }
+  s_tap_subscribed = true;
+  s_tap_pending = false;
+  accel_tap_service_subscribe(tap_handler);
+}
+
+static void tap_unsubscribe(){
+  if(!s_tap_subscribed) {
+    return;
+  }
+  s_tap_subscribed = false;
+  accel_tap_service_unsubscribe();
+}
+
+// --------------- GESTURES END ---------------
+
+// ----------------- SESSION -----------------
+
+// Carry out exactly the effects the transition table declared
+static void session_apply(uint16_t effects){
+  if((effects & SESSION_SHOW_WINDOW) && !window_stack_contains_window(s_spin_window)) {
+    window_stack_push(s_spin_window, true);
+  }
+  if(effects & SESSION_SUBSCRIBE) {
+    // Pick the power profile before the sensor, vibes and light depend on it
+    power_update();
+    power_subscribe(power_changed);
+    spin_engine_subscribe();
+  }
+  if((effects & SESSION_LIGHT) && power_profile()->backlight) {
+    light_enable_interaction();
+  }
+  if(effects & SESSION_VIBE_START) {
+    start_vibes();
+  }
+  if(effects & SESSION_ARM_TIMER) {
+    cancel_auto_snooze();
+    if(s_alarm_index >= 0 && load_persistent_storage_bool(AUTO_SNOOZE_KEY, false)) {
+      s_auto_snooze_timer = app_timer_register(AUTO_SNOOZE_MS, auto_snooze_callback, NULL);
+    }
+  }
+  if(effects & SESSION_RESET_SPIN) {
+    spin_reset(&s_spin);
+  }
+  if(effects & SESSION_SPIN_TEXT) {
+    set_spins_text();
+  }
+  if(effects & SESSION_REDRAW) {
+    redraw_spin();
+  }
+  if(effects & SESSION_SCHEDULE_SNOOZE) {
+    // The recurring alarm keeps its wakeup, deinit reschedules it as usual
+    alarm_snooze(s_alarm_index, s_snooze_minutes);
+  }
+  if(effects & SESSION_CANCEL_TIMER) {
+    cancel_auto_snooze();
+  }
+  if(effects & SESSION_VIBE_STOP) {
+    vibes_cancel();
+  }
+  if(effects & SESSION_UNSUBSCRIBE) {
+    spin_engine_unsubscribe();
+    power_unsubscribe();
+  }
+  if(effects & SESSION_HIDE_WINDOW) {
+    window_stack_remove(s_spin_window, true);
+    // The session is over, a later tutorial must not snooze this alarm
+    s_alarm_index = -1;
+  }
+  if(effects & SESSION_TAP_SUBSCRIBE) {
+    tap_subscribe();
+  }
+  if(effects & SESSION_TAP_UNSUBSCRIBE) {
+    tap_unsubscribe();
+  }
 }
 
+static void session_event(SessionEvent event){
+  session_apply(session_dispatch(event));
+}
+
+// --------------- SESSION END ---------------
+
 // ----------------- CLICKS -----------------
 
 static void spin_click_handler(ClickRecognizerRef recognizer, void *context) {
-  set_spinning(true);
+  latency_start(LATENCY_HOLD);
+  session_event(SESSION_EVENT_HOLD);
 }
 
 static void spin_release_handler(ClickRecognizerRef recognizer, void *context) {
-  set_spinning(false);
+  latency_start(LATENCY_RELEASE);
+  session_event(SESSION_EVENT_RELEASE);
+}
+
+static void back_click_handler(ClickRecognizerRef recognizer, void *context) {
+  // Back snoozes a ringing alarm, and just leaves the tutorial
+  if(s_alarm_index < 0) {
+    session_event(SESSION_EVENT_LEAVE);
+    return;
+  }
+  snooze();
 }
 
 void start_spin_click_config_provider(Window *window) {
   // Register the ClickHandlers
-  window_long_click_subscribe(BUTTON_ID_UP, 100, spin_click_handler, spin_release_handler);
-  window_long_click_subscribe(BUTTON_ID_SELECT, 100, spin_click_handler, spin_release_handler);
-  window_long_click_subscribe(BUTTON_ID_DOWN, 100, spin_click_handler, spin_release_handler);
-//   window_single_click_subscribe(BUTTON_ID_BACK, spin_click_handler);
+  window_long_click_subscribe(BUTTON_ID_UP, SPIN_LONG_CLICK_MS, spin_click_handler, spin_release_handler);
+  window_long_click_subscribe(BUTTON_ID_SELECT, SPIN_LONG_CLICK_MS, spin_click_handler, spin_release_handler);
+  window_long_click_subscribe(BUTTON_ID_DOWN, SPIN_LONG_CLICK_MS, spin_click_handler, spin_release_handler);
+  window_single_click_subscribe(BUTTON_ID_BACK, back_click_handler);
 }
 
 // -------------- CLICKS END ---------------
@@ -286,107 +530,48 @@ static void main_window_load(Window *window) {
   // Rects
   s_welcome_rect = GRect(112, s_center.y, 10, 10);
   
+  // Fonts
+  s_font_small = fonts_get_system_font(FONT_KEY_GOTHIC_14);
+  s_font_medium = fonts_get_system_font(FONT_KEY_GOTHIC_24);
+  s_font_large = fonts_get_system_font(FONT_KEY_GOTHIC_28);
+  
   // Welcome arrow
   s_welcome_arrow_path = gpath_create(&SPIN_ARROW_PATH_INFO);
   gpath_move_to(s_welcome_arrow_path, GPoint(120, s_center.y + 15));
-  s_welcome_canvas_layer = layer_create(window_bounds);
-  layer_set_update_proc(s_welcome_canvas_layer, update_welcome_proc);
-  layer_add_child(window_layer, s_welcome_canvas_layer);
-  
-  // Welcome text layer
-  s_welcome_text_layer = text_layer_create(GRect(10, s_center.y - 12, 144, 50));
-  text_layer_set_text(s_welcome_text_layer, "Press and hold");
-  text_layer_set_background_color(s_welcome_text_layer, GColorClear);
-  text_layer_set_text_color(s_welcome_text_layer, GColorWhite);
-  text_layer_set_font(s_welcome_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_24));
-  layer_add_child(window_layer, text_layer_get_layer(s_welcome_text_layer));
   
-  // Spin circle Layer
-  s_spin_circle_canvas_layer = layer_create(window_bounds);
-  layer_set_update_proc(s_spin_circle_canvas_layer, update_spin_circle_proc);
-  layer_add_child(window_layer, s_spin_circle_canvas_layer);
-  
-   // Spin triangle / arrow Layer
+  // Spin triangle / arrow
   s_spin_arrow_path = gpath_create(&SPIN_ARROW_PATH_INFO);
   s_spin_triangle_path = gpath_create(&BOLT_PATH_INFO);
   gpath_move_to(s_spin_triangle_path, s_spin_circle_center);
-  s_spin_triangle_canvas_layer = layer_create(window_bounds);
-  layer_set_update_proc(s_spin_triangle_canvas_layer, update_triangle_proc);
-  layer_add_child(window_layer, s_spin_triangle_canvas_layer);
-  
-  // Spin heading TextLayer
-  s_spin_heading_text_layer = text_layer_create(GRect(0, 5, 144, 50));
-  text_layer_set_text(s_spin_heading_text_layer, "To turn off alarm");
-  text_layer_set_background_color(s_spin_heading_text_layer, GColorClear);
-  text_layer_set_text_color(s_spin_heading_text_layer, GColorWhite);
-  text_layer_set_font(s_spin_heading_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_14));
-  text_layer_set_text_alignment(s_spin_heading_text_layer, GTextAlignmentCenter);
-  layer_add_child(window_layer, text_layer_get_layer(s_spin_heading_text_layer));
-  
-  // Spin top text TextLayer
-  s_spin_top_text_layer = text_layer_create(GRect(0, s_spin_circle_center.y - 30, 144, 50));
-  text_layer_set_text(s_spin_top_text_layer, "Spin Around");
-  text_layer_set_background_color(s_spin_top_text_layer, GColorClear);
-  text_layer_set_text_color(s_spin_top_text_layer, GColorWhite);
-  text_layer_set_font(s_spin_top_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_14));
-  text_layer_set_text_alignment(s_spin_top_text_layer, GTextAlignmentCenter);
-  layer_add_child(window_layer, text_layer_get_layer(s_spin_top_text_layer));
-  
-  // Spin spins TextLayer
-  s_spin_spins_text_layer = text_layer_create(GRect(0, s_spin_circle_center.y - 14, 144, 50));
-  text_layer_set_text(s_spin_spins_text_layer, "2");
-  text_layer_set_background_color(s_spin_spins_text_layer, GColorClear);
-  text_layer_set_text_color(s_spin_spins_text_layer, GColorWhite);
-  text_layer_set_font(s_spin_spins_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_28));
-  text_layer_set_text_alignment(s_spin_spins_text_layer, GTextAlignmentCenter);
-  layer_add_child(window_layer, text_layer_get_layer(s_spin_spins_text_layer));
-  
-  // Spin bottom text TextLayer
-  s_spin_bottom_text_layer = text_layer_create(GRect(0, s_spin_circle_center.y + 34 - 14, 144, 50));
-  text_layer_set_text(s_spin_bottom_text_layer, "Times!");
-  text_layer_set_background_color(s_spin_bottom_text_layer, GColorClear);
-  text_layer_set_text_color(s_spin_bottom_text_layer, GColorWhite);
-  text_layer_set_font(s_spin_bottom_text_layer, fonts_get_system_font(FONT_KEY_GOTHIC_14));
-  text_layer_set_text_alignment(s_spin_bottom_text_layer, GTextAlignmentCenter);
-  layer_add_child(window_layer, text_layer_get_layer(s_spin_bottom_text_layer));
-  
-  // Spin time TextLayer
-  s_spin_time_layer = text_layer_create(GRect(0, s_spin_circle_center.y + 38, 144, 50));
-  text_layer_set_background_color(s_spin_time_layer, GColorClear);
-  text_layer_set_text_color(s_spin_time_layer, GColorWhite);
-  text_layer_set_font(s_spin_time_layer, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD));
-  text_layer_set_text_alignment(s_spin_time_layer, GTextAlignmentCenter);
-//   layer_add_child(window_layer, text_layer_get_layer(s_spin_time_layer));
-  
-  // Register with TickTimerService
-  tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
-  
-  // Subscribe to the compass data service when angle changes by 5 degrees
-  compass_service_subscribe(compass_handler);
-  compass_service_set_heading_filter(5);
   
-  // Make sure the time is displayed from the start
-  update_time();
-  
-  // TODO: remove this
-  set_alarm_on(true);
+  // Spin canvas Layer
+  s_spin_canvas_layer = layer_create(window_bounds);
+  layer_set_update_proc(s_spin_canvas_layer, update_spin_proc);
+  layer_add_child(window_layer, s_spin_canvas_layer);
 }
 
 static void main_window_unload(Window *window) {
-    // Destroy TextLayer
-    text_layer_destroy(s_spin_time_layer);
+    // Destroy canvas and paths
+    layer_destroy(s_spin_canvas_layer);
+    s_spin_canvas_layer = NULL;
+    gpath_destroy(s_welcome_arrow_path);
+    gpath_destroy(s_spin_arrow_path);
+    gpath_destroy(s_spin_triangle_path);
+    
+    cancel_frame();
     
-    // Unsubscribe to acc. data service
-    accel_data_service_unsubscribe();
+    // Unsubscribe from the sensors, in case the app exits mid-session
+    spin_engine_unsubscribe();
+    tap_unsubscribe();
 }
 
-void spin_window_show(){
-  vibes_enqueue_custom_pattern(vibe_pat);
-  // Show the Window on the watch, with animated=true
-  window_stack_push(s_spin_window, true);
+#if FEATURE_TUTORIAL
+void spin_tutorial_show(){
+  session_event(SESSION_EVENT_TUTORIAL);
 }
+#endif
 
-void spin_window_init(Alarm *alarm) {
+void spin_window_init(void) {
   // Create spin Window element and assign to pointer
   s_spin_window = window_create();
   window_set_background_color(s_spin_window, GColorBlack);
@@ -403,16 +588,28 @@ void spin_window_init(Alarm *alarm) {
 }
 
 
+static void start_alarm(int32_t reason) {
+  s_alarm_index = WAKEUP_ALARM_INDEX(reason);
+  
+  // Shows the window, warms up the sensor together with the vibration and lights up
+  session_event(SESSION_EVENT_ALARM);
+}
+
 static void wakeup_handler(WakeupId id, int32_t reason) {
-  // The app has woken!
+  // The alarm went off while the app was open, ring right here
+  DEBUG_LOG("wakeup handler - alarm %d", (int)WAKEUP_ALARM_INDEX(reason));
+  
+  // The recurring wakeup was just consumed, schedule the next occurrence now
+  if(!(reason & WAKEUP_SNOOZE)) {
+    reschedule_wakeup();
+  }
+  start_alarm(reason);
 }
 
-void perform_wakeup_tasks(Alarm *alarm, bool *snooze)
+void perform_wakeup_tasks(bool *snooze)
 {
-  // Init windows
-  settings_window_init(alarm);
-  spin_window_init(alarm);
-  win_edit_init();
+  // Init windows, the settings and edit windows only when they can be reached
+  spin_window_init();
   
   s_snooze=snooze;
 
@@ -427,14 +624,16 @@ void perform_wakeup_tasks(Alarm *alarm, bool *snooze)
     
     // Get details and handle the wakeup
     wakeup_get_launch_event(&id, &reason);
-    s_alarm = alarm;
     
-    light_enable_interaction();
-    spin_window_show();
-    APP_LOG(APP_LOG_LEVEL_DEBUG, "perform wake up task - APP LAUNCH");
+    // A snooze leaves the recurring wakeup in place, so there is nothing to reschedule
+    *snooze = (reason & WAKEUP_SNOOZE) != 0;
+    start_alarm(reason);
+    DEBUG_LOG("perform wake up task - APP LAUNCH alarm %d", s_alarm_index);
   }
   else{
     *snooze=false;
+    settings_window_init();
+    win_edit_init();
     
     // Show the settings window
     settings_window_show();
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "alarm.h"
+#include "feature_switches.h"
 
-void spin_window_init(Alarm *alarm);
-void spin_window_show();
+void spin_window_init(void);
+#if FEATURE_TUTORIAL
+void spin_tutorial_show();
+#endif
   
-void perform_wakeup_tasks(Alarm* alarm, bool* snooze);
-void reschedule_wakeup(Alarm *alarm);
\ No newline at end of file
+void perform_wakeup_tasks(bool* snooze);
\ No newline at end of file
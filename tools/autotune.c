@@ -0,0 +1,322 @@
+// Parameter sweep for the compass spin detector.
+//
+// Replays a corpus of heading traces through spin_update_tuned() for every
+// point of a grid over the detector constants in spin.h, spread over all cores
+// with a work-stealing pool, and prints the Pareto front of dismissal
+// reliability against compass events and redraws per dismissal.
+//
+//   gcc -std=gnu99 -O2 -pthread -Itools/host -Isrc tools/autotune.c tools/trace.c src/spin.c -lm -o autotune
+//   ./autotune [--threads N] [--synth N] [trace...]
+//
+// Traces should be recorded without a heading filter, the sweep applies its own.
+// A trace counts as a dismissal attempt when its wearer turned at least once,
+// the wearer is assumed to keep spinning until the alarm stops or the trace ends.
+// The chosen point is printed as a --spin-tuning argument for the wscript.
+
+#include <pebble.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "spin.h"
+#include "trace.h"
+
+#define MAX_THREADS 64
+
+typedef struct Params{
+  int move_deg;
+  int step_deg;
+  int slack_deg;
+  int max_spins;
+  int filter_deg;
+  int long_click_ms;
+}Params;
+
+typedef struct Result{
+  Params params;
+  double reliability;     // balanced accuracy over attempts and non-attempts
+  double events;          // compass events per attempt, until dismissal
+  double redraws;         // spin window redraws per attempt, until dismissal
+  double latency_ms;      // mean time to dismissal
+  int detected;
+  int false_dismissals;
+}Result;
+
+// ---------------- GRID ----------------
+
+static const int s_move_deg[] = { 3, 5, 8 };
+static const int s_step_deg[] = { 5, 10, 15, 20 };
+static const int s_slack_deg[] = { 0, 20, 40 };
+static const int s_max_spins[] = { 2, 3, 4 };
+static const int s_filter_deg[] = { 0, 5, 10, 15 };
+static const int s_long_click_ms[] = { 100, 300, 600 };
+
+#define GRID_SIZE (ARRAY_LENGTH(s_move_deg) * ARRAY_LENGTH(s_step_deg) * ARRAY_LENGTH(s_slack_deg) * \
+                   ARRAY_LENGTH(s_max_spins) * ARRAY_LENGTH(s_filter_deg) * ARRAY_LENGTH(s_long_click_ms))
+
+static Params grid_point(int index){
+  Params params;
+#define NEXT_AXIS(field, axis) \
+  params.field = axis[index % ARRAY_LENGTH(axis)]; \
+  index /= ARRAY_LENGTH(axis);
+  NEXT_AXIS(move_deg, s_move_deg)
+  NEXT_AXIS(step_deg, s_step_deg)
+  NEXT_AXIS(slack_deg, s_slack_deg)
+  NEXT_AXIS(max_spins, s_max_spins)
+  NEXT_AXIS(filter_deg, s_filter_deg)
+  NEXT_AXIS(long_click_ms, s_long_click_ms)
+#undef NEXT_AXIS
+  return params;
+}
+
+// ---------------- GRID END ----------------
+
+static Trace **s_corpus;
+static int s_corpus_size;
+static Result s_results[GRID_SIZE];
+
+// Mirrors set_spin_angle() in wakeup.c for one hold that starts at the first sample
+static void replay_trace(const Params *params, const Trace *trace, int *events, int *redraws, int32_t *dismissed_ms){
+  const SpinTuning tuning = { params->move_deg, params->step_deg, params->slack_deg };
+  SpinState spin;
+  int32_t last_heading = 0;
+  bool first = true;
+
+  spin_reset(&spin);
+  spin.prev_heading = 0;
+  *dismissed_ms = -1;
+  for(int i = 0; i < trace->num_samples; i++) {
+    const Sample *sample = &trace->samples[i];
+    if(sample->kind != 'c')
+      continue;
+    if(!first && !trace_heading_passes(&last_heading, sample->v[0], params->filter_deg))
+      continue;
+    first = false;
+    last_heading = sample->v[0];
+    (*events)++;
+
+    // Until the long click fires only the baseline heading is tracked
+    if(sample->ms < params->long_click_ms) {
+      spin.prev_heading = sample->v[0];
+      continue;
+    }
+    if(!spin_update_tuned(&spin, sample->v[0], &tuning))
+      continue;
+    (*redraws)++;
+    if(spin.spins >= params->max_spins) {
+      *dismissed_ms = sample->ms;
+      return;
+    }
+  }
+}
+
+static void evaluate(int index){
+  Result *result = &s_results[index];
+  int attempts = 0, others = 0, events = 0, redraws = 0;
+  int64_t latency_ms = 0;
+
+  result->params = grid_point(index);
+  for(int i = 0; i < s_corpus_size; i++) {
+    const Trace *trace = s_corpus[i];
+    int trace_events = 0, trace_redraws = 0;
+    int32_t dismissed_ms;
+    replay_trace(&result->params, trace, &trace_events, &trace_redraws, &dismissed_ms);
+    if(trace->spins > 0) {
+      attempts++;
+      events += trace_events;
+      redraws += trace_redraws;
+      if(dismissed_ms >= 0) {
+        result->detected++;
+        latency_ms += dismissed_ms;
+      }
+    } else {
+      others++;
+      if(dismissed_ms >= 0)
+        result->false_dismissals++;
+    }
+  }
+
+  double detection = attempts ? (double)result->detected / attempts : 1;
+  double rejection = others ? 1 - (double)result->false_dismissals / others : 1;
+  result->reliability = (detection + rejection) / 2;
+  result->events = attempts ? (double)events / attempts : 0;
+  result->redraws = attempts ? (double)redraws / attempts : 0;
+  result->latency_ms = result->detected ? (double)latency_ms / result->detected : -1;
+}
+
+// ---------------- WORK-STEALING POOL ----------------
+
+// Each worker owns a deque of grid indices, taking work from its tail. An idle
+// worker steals from the head of the others. No work is added once the pool
+// runs, so a worker that finds every deque empty is done.
+typedef struct Deque{
+  pthread_mutex_t lock;
+  int head;
+  int tail;
+  int *jobs;
+}Deque;
+
+typedef struct Worker{
+  pthread_t thread;
+  int id;
+  int done;
+  int stolen;
+}Worker;
+
+static Deque s_deques[MAX_THREADS];
+static Worker s_workers[MAX_THREADS];
+static int s_num_workers;
+
+static bool deque_pop(Deque *deque, int *job){
+  bool found = false;
+  pthread_mutex_lock(&deque->lock);
+  if(deque->head < deque->tail) {
+    *job = deque->jobs[--deque->tail];
+    found = true;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+static bool deque_steal(Deque *deque, int *job){
+  bool found = false;
+  pthread_mutex_lock(&deque->lock);
+  if(deque->head < deque->tail) {
+    *job = deque->jobs[deque->head++];
+    found = true;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+static void *worker_main(void *context){
+  Worker *worker = context;
+  int job;
+
+  for(;;) {
+    if(deque_pop(&s_deques[worker->id], &job)) {
+      evaluate(job);
+      worker->done++;
+      continue;
+    }
+    bool stole = false;
+    for(int i = 1; i < s_num_workers && !stole; i++) {
+      Deque *victim = &s_deques[(worker->id + i) % s_num_workers];
+      stole = deque_steal(victim, &job);
+    }
+    if(!stole)
+      return NULL;
+    evaluate(job);
+    worker->done++;
+    worker->stolen++;
+  }
+}
+
+static void run_pool(int num_jobs){
+  // Deal the grid out in contiguous blocks, neighbouring points cost about the same
+  // so the blocks are uneven in cost and stealing evens them out
+  for(int w = 0; w < s_num_workers; w++) {
+    Deque *deque = &s_deques[w];
+    int first = num_jobs * w / s_num_workers;
+    int last = num_jobs * (w + 1) / s_num_workers;
+    pthread_mutex_init(&deque->lock, NULL);
+    deque->jobs = malloc((last - first) * sizeof(int));
+    deque->head = 0;
+    deque->tail = 0;
+    for(int job = last - 1; job >= first; job--)
+      deque->jobs[deque->tail++] = job;
+  }
+  for(int w = 0; w < s_num_workers; w++) {
+    s_workers[w].id = w;
+    pthread_create(&s_workers[w].thread, NULL, worker_main, &s_workers[w]);
+  }
+  for(int w = 0; w < s_num_workers; w++) {
+    pthread_join(s_workers[w].thread, NULL);
+    pthread_mutex_destroy(&s_deques[w].lock);
+    free(s_deques[w].jobs);
+  }
+}
+
+// ---------------- WORK-STEALING POOL END ----------------
+
+static bool dominates(const Result *a, const Result *b){
+  bool no_worse = a->reliability >= b->reliability && a->events <= b->events && a->redraws <= b->redraws;
+  bool better = a->reliability > b->reliability || a->events < b->events || a->redraws < b->redraws;
+  return no_worse && better;
+}
+
+static int compare_front(const void *a, const void *b){
+  const Result *x = *(const Result **)a, *y = *(const Result **)b;
+  if(x->reliability != y->reliability)
+    return x->reliability > y->reliability ? -1 : 1;
+  return x->events < y->events ? -1 : x->events > y->events;
+}
+
+static void print_tuning(const Params *params){
+  printf("--spin-tuning MAX_SPINS=%d,SPIN_MOVE_DEG=%d,SPIN_STEP_DEG=%d,SPIN_SLACK_DEG=%d,"
+         "SPIN_HEADING_FILTER_DEG=%d,SPIN_LONG_CLICK_MS=%d\n",
+         params->max_spins, params->move_deg, params->step_deg, params->slack_deg,
+         params->filter_deg, params->long_click_ms);
+}
+
+int main(int argc, char **argv){
+  int threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int synth = 0;
+
+  s_corpus = malloc(argc * sizeof(Trace *) + sizeof(Trace *));
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "--synth") == 0 && i + 1 < argc) {
+      synth = atoi(argv[++i]);
+    } else {
+      Trace *trace = malloc(sizeof(Trace));
+      if(!trace_load(argv[i], trace))
+        return 1;
+      s_corpus[s_corpus_size++] = trace;
+    }
+  }
+  if(!s_corpus_size && !synth) {
+    fprintf(stderr, "usage: %s [--threads N] [--synth N] [trace...]\n", argv[0]);
+    return 1;
+  }
+
+  s_corpus = realloc(s_corpus, (s_corpus_size + synth) * sizeof(Trace *));
+  for(int i = 0; i < synth; i++) {
+    // Every fourth trace is a negative, the wearer is not trying to dismiss
+    Trace *trace = malloc(sizeof(Trace));
+    trace_synth(trace, i, 0.3 + 0.05 * (i % 10), (i % 4 == 3) ? 0 : 6);
+    s_corpus[s_corpus_size++] = trace;
+  }
+
+  s_num_workers = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+  run_pool(GRID_SIZE);
+
+  int stolen = 0;
+  for(int w = 0; w < s_num_workers; w++)
+    stolen += s_workers[w].stolen;
+  printf("%d grid points x %d traces on %d threads, %d points stolen\n",
+         (int)GRID_SIZE, s_corpus_size, s_num_workers, stolen);
+
+  static Result *front[GRID_SIZE];
+  int front_size = 0;
+  for(int i = 0; i < (int)GRID_SIZE; i++) {
+    bool dominated = false;
+    for(int j = 0; j < (int)GRID_SIZE && !dominated; j++)
+      dominated = dominates(&s_results[j], &s_results[i]);
+    if(!dominated)
+      front[front_size++] = &s_results[i];
+  }
+  qsort(front, front_size, sizeof(Result *), compare_front);
+
+  printf("reliab  events redraws latency  det  false  spins move step slack filter hold\n");
+  for(int i = 0; i < front_size; i++) {
+    const Result *r = front[i];
+    printf("%6.3f %7.1f %7.1f %6.0f ms %4d %5d %6d %4d %4d %5d %6d %4d\n",
+           r->reliability, r->events, r->redraws, r->latency_ms, r->detected, r->false_dismissals,
+           r->params.max_spins, r->params.move_deg, r->params.step_deg, r->params.slack_deg,
+           r->params.filter_deg, r->params.long_click_ms);
+  }
+  if(front_size)
+    print_tuning(&front[0]->params);
+  return 0;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+// Stand-in for the Pebble SDK header so src/ can be built into desktop tools.
+// Types and prototypes only; each tool provides the services it exercises
+// (see tools/replay.c and tools/nightsim.c).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define APP_LOG_LEVEL_ERROR 1
+#define APP_LOG_LEVEL_WARNING 50
+#define APP_LOG_LEVEL_INFO 100
+#define APP_LOG_LEVEL_DEBUG 200
+#define APP_LOG(level, fmt, ...) host_log(level, fmt, ##__VA_ARGS__)
+void host_log(int level, const char *fmt, ...);
+
+// The app reads the watch clock, which tools drive themselves
+#define time(tloc) host_time(tloc)
+time_t host_time(time_t *tloc);
+
+#define ARRAY_LENGTH(a) (sizeof(a)/sizeof((a)[0]))
+#define TRIG_MAX_ANGLE 0x10000
+#define TRIG_MAX_RATIO 0xffff
+#define TRIGANGLE_TO_DEG(a) (((a) * 360) / TRIG_MAX_ANGLE)
+#define DEG_TO_TRIGANGLE(a) (((a) * TRIG_MAX_ANGLE) / 360)
+#define PERSIST_DATA_MAX_LENGTH 256
+#define E_DOES_NOT_EXIST -10
+typedef int32_t WakeupId; typedef int32_t status_t;
+typedef enum { TODAY=0, SUNDAY, MONDAY, TUESDAY, WEDNESDAY, THURSDAY, FRIDAY, SATURDAY } WeekDay;
+typedef enum { APP_LAUNCH_SYSTEM, APP_LAUNCH_USER, APP_LAUNCH_WAKEUP } AppLaunchReason;
+typedef struct { int16_t x, y; } GPoint; typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+#define GPoint(x,y) ((GPoint){(x),(y)})
+#define GSize(w,h) ((GSize){(w),(h)})
+#define GRect(x,y,w,h) ((GRect){{(x),(y)},{(w),(h)}})
+typedef struct { uint8_t argb; } GColor;
+#define GColorBlack ((GColor){0xC0})
+#define GColorWhite ((GColor){0xFF})
+#define GColorClear ((GColor){0})
+#define GColorDukeBlue ((GColor){0xC2})
+#define GColorDarkGray ((GColor){0xD5})
+typedef struct Layer Layer; typedef struct Window Window; typedef struct TextLayer TextLayer;
+typedef struct MenuLayer MenuLayer; typedef struct GContext GContext; typedef struct GPath GPath;
+typedef struct GFont_ *GFont; typedef void *ClickRecognizerRef;
+typedef struct { uint32_t num_points; GPoint *points; } GPathInfo;
+typedef enum { GTextOverflowModeWordWrap, GTextOverflowModeTrailingEllipsis, GTextOverflowModeFill } GTextOverflowMode;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GCornerNone } GCornerMask;
+typedef struct GTextAttributes GTextAttributes;
+typedef void (*LayerUpdateProc)(Layer *, GContext *);
+typedef void (*WindowHandler)(Window *);
+typedef struct { WindowHandler load, appear, disappear, unload; } WindowHandlers;
+typedef void (*ClickHandler)(ClickRecognizerRef, void *);
+typedef void (*ClickConfigProvider)(void *);
+typedef enum { BUTTON_ID_BACK, BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN } ButtonId;
+typedef struct { uint16_t section, row; } MenuIndex;
+typedef struct { uint16_t (*get_num_sections)(MenuLayer*, void*); uint16_t (*get_num_rows)(MenuLayer*, uint16_t, void*);
+  int16_t (*get_cell_height)(MenuLayer*, MenuIndex*, void*); int16_t (*get_header_height)(MenuLayer*, uint16_t, void*);
+  void (*draw_row)(GContext*, const Layer*, MenuIndex*, void*); void (*draw_header)(GContext*, const Layer*, uint16_t, void*);
+  void (*select_click)(MenuLayer*, MenuIndex*, void*); void (*select_long_click)(MenuLayer*, MenuIndex*, void*);
+  void (*selection_changed)(MenuLayer*, MenuIndex, MenuIndex, void*); } MenuLayerCallbacks;
+typedef enum { MenuRowAlignNone, MenuRowAlignCenter } MenuRowAlign;
+typedef enum { CompassStatusDataInvalid, CompassStatusCalibrating, CompassStatusCalibrated } CompassStatus;
+typedef int32_t CompassHeading;
+typedef struct { CompassHeading magnetic_heading, true_heading; CompassStatus compass_status; bool is_declination_valid; } CompassHeadingData;
+typedef void (*CompassHeadingHandler)(CompassHeadingData);
+typedef struct { int16_t x, y, z; bool did_vibrate; uint64_t timestamp; } AccelData;
+typedef void (*AccelDataHandler)(AccelData *, uint32_t);
+typedef enum { ACCEL_AXIS_X, ACCEL_AXIS_Y, ACCEL_AXIS_Z } AccelAxisType;
+typedef void (*AccelTapHandler)(AccelAxisType, int32_t);
+typedef enum { ACCEL_SAMPLING_10HZ=10, ACCEL_SAMPLING_25HZ=25, ACCEL_SAMPLING_50HZ=50, ACCEL_SAMPLING_100HZ=100 } AccelSamplingRate;
+typedef struct { uint8_t charge_percent; bool is_charging, is_plugged; } BatteryChargeState;
+typedef void (*BatteryStateHandler)(BatteryChargeState);
+typedef enum { SECOND_UNIT=1, MINUTE_UNIT=2 } TimeUnits;
+typedef void (*TickHandler)(struct tm *, TimeUnits);
+typedef void (*WakeupHandler)(WakeupId, int32_t);
+typedef struct { const uint32_t *durations; uint32_t num_segments; } VibePattern;
+typedef void (*AppTimerCallback)(void *); typedef struct AppTimer AppTimer;
+#define FONT_KEY_GOTHIC_14 "a"
+#define FONT_KEY_GOTHIC_14_BOLD "a"
+#define FONT_KEY_GOTHIC_18 "a"
+#define FONT_KEY_GOTHIC_18_BOLD "a"
+#define FONT_KEY_GOTHIC_24 "a"
+#define FONT_KEY_GOTHIC_24_BOLD "a"
+#define FONT_KEY_GOTHIC_28 "a"
+#define FONT_KEY_GOTHIC_28_BOLD "a"
+Layer *layer_create(GRect); void layer_destroy(Layer*); void layer_set_update_proc(Layer*, LayerUpdateProc);
+void layer_add_child(Layer*, Layer*); void layer_mark_dirty(Layer*); void layer_set_hidden(Layer*, bool);
+GRect layer_get_bounds(const Layer*); GRect layer_get_frame(const Layer*);
+GPoint grect_center_point(const GRect*);
+Window *window_create(void); void window_destroy(Window*); void window_set_background_color(Window*, GColor);
+void window_set_window_handlers(Window*, WindowHandlers); Layer *window_get_root_layer(const Window*);
+void window_set_click_config_provider(Window*, ClickConfigProvider);
+void window_stack_push(Window*, bool); Window *window_stack_pop(bool); bool window_stack_remove(Window*, bool);
+Window *window_stack_get_top_window(void); bool window_stack_contains_window(Window*);
+void window_long_click_subscribe(ButtonId, uint16_t, ClickHandler, ClickHandler);
+void window_single_click_subscribe(ButtonId, ClickHandler);
+void window_single_repeating_click_subscribe(ButtonId, uint16_t, ClickHandler);
+TextLayer *text_layer_create(GRect); void text_layer_destroy(TextLayer*); void text_layer_set_text(TextLayer*, const char*);
+void text_layer_set_background_color(TextLayer*, GColor); void text_layer_set_text_color(TextLayer*, GColor);
+void text_layer_set_font(TextLayer*, GFont); void text_layer_set_text_alignment(TextLayer*, GTextAlignment);
+Layer *text_layer_get_layer(TextLayer*);
+GFont fonts_get_system_font(const char*);
+void graphics_context_set_text_color(GContext*, GColor); void graphics_context_set_fill_color(GContext*, GColor);
+void graphics_context_set_stroke_color(GContext*, GColor);
+void graphics_fill_rect(GContext*, GRect, uint16_t, GCornerMask); void graphics_fill_circle(GContext*, GPoint, uint16_t);
+void graphics_draw_text(GContext*, const char*, GFont, GRect, GTextOverflowMode, GTextAlignment, GTextAttributes*);
+GPath *gpath_create(const GPathInfo*); void gpath_destroy(GPath*); void gpath_move_to(GPath*, GPoint);
+void gpath_rotate_to(GPath*, int32_t); void gpath_draw_filled(GContext*, GPath*);
+int32_t sin_lookup(int32_t); int32_t cos_lookup(int32_t);
+MenuLayer *menu_layer_create(GRect); void menu_layer_destroy(MenuLayer*); void menu_layer_set_callbacks(MenuLayer*, void*, MenuLayerCallbacks);
+void menu_layer_set_click_config_onto_window(MenuLayer*, Window*); Layer *menu_layer_get_layer(const MenuLayer*);
+void menu_layer_reload_data(MenuLayer*); MenuIndex menu_layer_get_selected_index(const MenuLayer*);
+void menu_layer_set_selected_index(MenuLayer*, MenuIndex, int, bool);
+void menu_cell_basic_draw(GContext*, const Layer*, const char*, const char*, void*);
+bool persist_exists(uint32_t); int persist_read_data(uint32_t, void*, size_t); int persist_write_data(uint32_t, const void*, size_t);
+bool persist_read_bool(uint32_t); int32_t persist_read_int(uint32_t); status_t persist_write_bool(uint32_t, bool);
+status_t persist_write_int(uint32_t, int32_t); status_t persist_delete(uint32_t);
+void compass_service_subscribe(CompassHeadingHandler); void compass_service_unsubscribe(void); int compass_service_set_heading_filter(CompassHeading);
+int compass_service_peek(CompassHeadingData*);
+void accel_data_service_subscribe(uint32_t, AccelDataHandler); void accel_data_service_unsubscribe(void);
+int accel_service_set_sampling_rate(AccelSamplingRate); int accel_service_set_samples_per_update(uint32_t);
+void accel_tap_service_subscribe(AccelTapHandler); void accel_tap_service_unsubscribe(void);
+void battery_state_service_subscribe(BatteryStateHandler); void battery_state_service_unsubscribe(void); BatteryChargeState battery_state_service_peek(void);
+void tick_timer_service_subscribe(TimeUnits, TickHandler); void tick_timer_service_unsubscribe(void);
+void vibes_cancel(void); void vibes_enqueue_custom_pattern(VibePattern); void vibes_short_pulse(void); void vibes_long_pulse(void);
+void light_enable_interaction(void); void light_enable(bool);
+bool clock_is_24h_style(void); time_t clock_to_timestamp(WeekDay, int, int);
+void wakeup_service_subscribe(WakeupHandler); WakeupId wakeup_schedule(time_t, int32_t, bool); void wakeup_cancel(WakeupId);
+void wakeup_cancel_all(void); bool wakeup_get_launch_event(WakeupId*, int32_t*); bool wakeup_query(WakeupId, time_t*);
+AppLaunchReason launch_reason(void); void app_event_loop(void);
+uint16_t time_ms(time_t*, uint16_t*);
+AppTimer *app_timer_register(uint32_t, AppTimerCallback, void*); void app_timer_cancel(AppTimer*); bool app_timer_reschedule(AppTimer*, uint32_t);
@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+"""Decode latency probe dumps from the app log.
+
+Select the Latency row in the settings menu to dump the samples, then:
+
+    pebble logs | python tools/latency_decode.py
+    python tools/latency_decode.py saved.log
+
+Each dump line looks like "LAT <kind> <count> <offset> <hex>", with four hex
+digits per sample in milliseconds (see latency_log() in src/latency.c).
+"""
+
+import fileinput
+import re
+
+KINDS = ['Hold', 'Release', 'Spin', 'Edit']
+LINE = re.compile(r'LAT (\d+) (\d+) (\d+) ([0-9a-f]*)')
+
+
+def percentile(sorted_samples, pct):
+    # Same rank rule as latency_get_stats()
+    return sorted_samples[(len(sorted_samples) * pct - 1) // 100]
+
+
+def main():
+    samples = {}
+    counts = {}
+    for line in fileinput.input():
+        match = LINE.search(line)
+        if not match:
+            continue
+        kind, count, offset, data = int(match.group(1)), int(match.group(2)), int(match.group(3)), match.group(4)
+        if offset == 0:
+            samples[kind] = []
+        counts[kind] = count
+        samples.setdefault(kind, []).extend(int(data[i:i + 4], 16) for i in range(0, len(data), 4))
+
+    print('{:<8} {:>6} {:>6} {:>6} {:>6} {:>6}'.format('kind', 'count', 'min', 'avg', 'max', 'p95'))
+    for kind in sorted(samples):
+        values = sorted(samples[kind])
+        if not values:
+            continue
+        name = KINDS[kind] if kind < len(KINDS) else str(kind)
+        print('{:<8} {:>6} {:>6} {:>6} {:>6} {:>6}'.format(
+            name, counts[kind], values[0], sum(values) // len(values), values[-1], percentile(values, 95)))
+
+
+if __name__ == '__main__':
+    main()
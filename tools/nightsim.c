@@ -0,0 +1,853 @@
+// Virtual-clock night simulator for the scheduling and storage paths.
+//
+// Runs the real init()/deinit() from src/main.c, and with them
+// perform_wakeup_tasks() and reschedule_wakeup(), against a simulated clock,
+// wakeup service and persistent storage. Every launch runs in its own forked
+// process so app statics start fresh, exactly like a relaunch on the watch.
+//
+//   gcc -std=gnu99 -O2 -Itools/host -Isrc -Wl,--wrap=reschedule_wakeup -o nightsim
+//       tools/nightsim.c src/alarm.c src/storage.c src/wakeup.c src/settings.c
+//       src/edit.c src/spin.c src/accel.c src/latency.c src/session.c src/format.c
+//       src/power.c
+//   ./nightsim [--start YYYY-MM-DD] [--weeks N] [--tz ZONE] [--battery PERCENT] [--verbose]
+//
+// The scripted weeks include snoozes, evenings where the settings are opened,
+// a wrong clock that gets corrected, a reboot across the alarm, a trip to
+// another timezone and whatever DST transitions fall into the range.
+
+#define main pebble_app_main
+#include "../src/main.c"
+#undef main
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "accel.h"
+#include "session.h"
+
+#define PERSIST_KEYS 64
+#define MAX_WAKEUPS 8
+#define MAX_FIRES 512
+#define MAX_WINDOWS 8
+#define MAX_TIMERS 4
+#define MINUTE_S 60
+#define DAY_S (24 * 60 * 60)
+
+#define ALARM_HOUR 7
+#define ALARM_MINUTE 0
+
+#define E_RANGE -8
+#define E_OUT_OF_RESOURCES -7
+
+typedef struct PersistEntry{
+  bool exists;
+  uint16_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+}PersistEntry;
+
+typedef struct WakeupSlot{
+  bool used;
+  WakeupId id;
+  time_t timestamp;
+  int32_t cookie;
+}WakeupSlot;
+
+typedef struct Fire{
+  int date;        // local yyyymmdd on the watch
+  int minute;      // local minute of the day on the watch
+  bool snooze;
+  bool missed;     // came due while the watch was off or the clock jumped past it
+}Fire;
+
+typedef struct Stats{
+  int launches;
+  int wakeup_calls;
+  int persist_writes;
+  int persist_reads;
+  int reschedules;
+  int clock_calls;
+  int64_t reschedule_ns;
+  int64_t reschedule_max_ns;
+  int undismissed;
+  int still_dismissals;  // dismissed while the wearer held the button without moving
+}Stats;
+
+// Everything that outlives a launch lives in shared memory
+typedef struct Sim{
+  time_t real;       // true UTC
+  time_t offset;     // watch clock error after a manual clock change
+  bool powered;
+  PersistEntry persist[PERSIST_KEYS];
+  WakeupSlot wakeups[MAX_WAKEUPS];
+  WakeupId next_id;
+  AppLaunchReason launch_reason;
+  WakeupId launch_id;
+  int32_t launch_cookie;
+  int num_fires;
+  Fire fires[MAX_FIRES];
+  Stats stats;
+}Sim;
+
+static Sim *s_sim;
+static bool s_verbose;
+static uint8_t s_battery = 80;
+
+// ---------------- PLATFORM ----------------
+
+void host_log(int level, const char *fmt, ...){
+  if(!s_verbose)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  printf("    app: ");
+  vprintf(fmt, args);
+  printf("\n");
+  va_end(args);
+}
+
+time_t host_time(time_t *tloc){
+  time_t now = s_sim->real + s_sim->offset;
+  if(tloc)
+    *tloc = now;
+  return now;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms){
+  host_time(tloc);
+  if(out_ms)
+    *out_ms = 0;
+  return 0;
+}
+
+bool clock_is_24h_style(void){ return true; }
+
+// Next occurrence in the future; TODAY with a time already passed means a week ahead
+time_t clock_to_timestamp(WeekDay day, int hour, int minute){
+  time_t now = host_time(NULL);
+  struct tm tm = *localtime(&now);
+  int days = 0;
+
+  s_sim->stats.clock_calls++;
+  if(day != TODAY)
+    days = ((day - 1) - tm.tm_wday + 7) % 7;
+  tm.tm_hour = hour;
+  tm.tm_min = minute;
+  tm.tm_sec = 0;
+  tm.tm_isdst = -1;
+  tm.tm_mday += days;
+  time_t timestamp = mktime(&tm);
+  if(timestamp <= now) {
+    tm.tm_mday += 7;
+    tm.tm_isdst = -1;
+    timestamp = mktime(&tm);
+  }
+  return timestamp;
+}
+
+AppLaunchReason launch_reason(void){ return s_sim->launch_reason; }
+void app_event_loop(void){}
+
+// Persistent storage
+
+static PersistEntry *persist_entry(uint32_t key){
+  if(key >= PERSIST_KEYS) {
+    fprintf(stderr, "persist key %u out of range\n", key);
+    exit(1);
+  }
+  return &s_sim->persist[key];
+}
+
+bool persist_exists(uint32_t key){ return persist_entry(key)->exists; }
+
+int persist_read_data(uint32_t key, void *buffer, size_t size){
+  PersistEntry *entry = persist_entry(key);
+  s_sim->stats.persist_reads++;
+  if(!entry->exists)
+    return E_DOES_NOT_EXIST;
+  size = size < entry->size ? size : entry->size;
+  memcpy(buffer, entry->data, size);
+  return size;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size){
+  PersistEntry *entry = persist_entry(key);
+  s_sim->stats.persist_writes++;
+  size = size < PERSIST_DATA_MAX_LENGTH ? size : PERSIST_DATA_MAX_LENGTH;
+  memcpy(entry->data, data, size);
+  entry->size = size;
+  entry->exists = true;
+  return size;
+}
+
+int32_t persist_read_int(uint32_t key){
+  int32_t value = 0;
+  persist_read_data(key, &value, sizeof(value));
+  return value;
+}
+
+bool persist_read_bool(uint32_t key){ return persist_read_int(key) != 0; }
+status_t persist_write_int(uint32_t key, int32_t value){ return persist_write_data(key, &value, sizeof(value)); }
+status_t persist_write_bool(uint32_t key, bool value){ return persist_write_int(key, value); }
+
+status_t persist_delete(uint32_t key){
+  s_sim->stats.persist_writes++;
+  persist_entry(key)->exists = false;
+  return 0;
+}
+
+// Wakeup service
+
+WakeupId wakeup_schedule(time_t timestamp, int32_t cookie, bool notify_if_missed){
+  WakeupSlot *free_slot = NULL;
+
+  s_sim->stats.wakeup_calls++;
+  for(int i = 0; i < MAX_WAKEUPS; i++) {
+    WakeupSlot *slot = &s_sim->wakeups[i];
+    if(!slot->used) {
+      free_slot = free_slot ? free_slot : slot;
+    } else if(labs(slot->timestamp - timestamp) < MINUTE_S) {
+      return E_RANGE;
+    }
+  }
+  if(!free_slot)
+    return E_OUT_OF_RESOURCES;
+  *free_slot = (WakeupSlot){ true, ++s_sim->next_id, timestamp, cookie };
+  return free_slot->id;
+}
+
+void wakeup_cancel(WakeupId id){
+  s_sim->stats.wakeup_calls++;
+  for(int i = 0; i < MAX_WAKEUPS; i++) {
+    if(s_sim->wakeups[i].used && s_sim->wakeups[i].id == id)
+      s_sim->wakeups[i].used = false;
+  }
+}
+
+void wakeup_cancel_all(void){
+  s_sim->stats.wakeup_calls++;
+  for(int i = 0; i < MAX_WAKEUPS; i++)
+    s_sim->wakeups[i].used = false;
+}
+
+bool wakeup_query(WakeupId id, time_t *timestamp){
+  s_sim->stats.wakeup_calls++;
+  for(int i = 0; i < MAX_WAKEUPS; i++) {
+    if(s_sim->wakeups[i].used && s_sim->wakeups[i].id == id) {
+      if(timestamp)
+        *timestamp = s_sim->wakeups[i].timestamp;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool wakeup_get_launch_event(WakeupId *id, int32_t *cookie){
+  *id = s_sim->launch_id;
+  *cookie = s_sim->launch_cookie;
+  return s_sim->launch_reason == APP_LAUNCH_WAKEUP;
+}
+
+static WakeupHandler s_wakeup_handler;
+void wakeup_service_subscribe(WakeupHandler handler){ s_wakeup_handler = handler; }
+
+// Sensors and timers, driven by the simulated user
+
+static CompassHeadingHandler s_compass_handler;
+static AccelDataHandler s_accel_handler;
+
+void compass_service_subscribe(CompassHeadingHandler handler){ s_compass_handler = handler; }
+void compass_service_unsubscribe(void){ s_compass_handler = NULL; }
+int compass_service_set_heading_filter(CompassHeading filter){ return 0; }
+int compass_service_peek(CompassHeadingData *data){ return -1; }
+void accel_data_service_subscribe(uint32_t samples, AccelDataHandler handler){ s_accel_handler = handler; }
+void accel_data_service_unsubscribe(void){ s_accel_handler = NULL; }
+int accel_service_set_sampling_rate(AccelSamplingRate rate){ return 0; }
+int accel_service_set_samples_per_update(uint32_t samples){ return 0; }
+void accel_tap_service_subscribe(AccelTapHandler handler){}
+void accel_tap_service_unsubscribe(void){}
+void battery_state_service_subscribe(BatteryStateHandler handler){}
+void battery_state_service_unsubscribe(void){}
+BatteryChargeState battery_state_service_peek(void){ return (BatteryChargeState){ s_battery, false, false }; }
+void tick_timer_service_subscribe(TimeUnits units, TickHandler handler){}
+void tick_timer_service_unsubscribe(void){}
+
+struct AppTimer{
+  bool used;
+  AppTimerCallback callback;
+  void *data;
+};
+static struct AppTimer s_timers[MAX_TIMERS];
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *data){
+  for(int i = 0; i < MAX_TIMERS; i++) {
+    if(!s_timers[i].used) {
+      s_timers[i] = (struct AppTimer){ true, callback, data };
+      return &s_timers[i];
+    }
+  }
+  return NULL;
+}
+void app_timer_cancel(AppTimer *timer){ timer->used = false; }
+bool app_timer_reschedule(AppTimer *timer, uint32_t timeout_ms){ return timer->used; }
+
+void vibes_cancel(void){}
+void vibes_enqueue_custom_pattern(VibePattern pattern){}
+void vibes_short_pulse(void){}
+void vibes_long_pulse(void){}
+void light_enable_interaction(void){}
+void light_enable(bool enable){}
+
+// ---------------- UI ----------------
+
+struct Layer{
+  GRect frame;
+  LayerUpdateProc update_proc;
+};
+struct TextLayer{ struct Layer layer; };
+struct MenuLayer{ struct Layer layer; };
+struct GPath{ int unused; };
+struct Window{
+  struct Layer root;
+  WindowHandlers handlers;
+  ClickConfigProvider click_config;
+  bool loaded;
+};
+
+static Window *s_stack[MAX_WINDOWS];
+static int s_depth;
+static ClickHandler s_single_click[4], s_long_down[4], s_long_up[4];
+
+Layer *layer_create(GRect frame){
+  Layer *layer = calloc(1, sizeof(Layer));
+  layer->frame = frame;
+  return layer;
+}
+void layer_destroy(Layer *layer){ free(layer); }
+void layer_set_update_proc(Layer *layer, LayerUpdateProc proc){ layer->update_proc = proc; }
+void layer_add_child(Layer *parent, Layer *child){}
+void layer_mark_dirty(Layer *layer){}
+void layer_set_hidden(Layer *layer, bool hidden){}
+GRect layer_get_bounds(const Layer *layer){ return GRect(0, 0, layer->frame.size.w, layer->frame.size.h); }
+GRect layer_get_frame(const Layer *layer){ return layer->frame; }
+GPoint grect_center_point(const GRect *rect){ return GPoint(rect->origin.x + rect->size.w / 2, rect->origin.y + rect->size.h / 2); }
+
+TextLayer *text_layer_create(GRect frame){ return (TextLayer *)layer_create(frame); }
+void text_layer_destroy(TextLayer *layer){ free(layer); }
+void text_layer_set_text(TextLayer *layer, const char *text){}
+void text_layer_set_background_color(TextLayer *layer, GColor color){}
+void text_layer_set_text_color(TextLayer *layer, GColor color){}
+void text_layer_set_font(TextLayer *layer, GFont font){}
+void text_layer_set_text_alignment(TextLayer *layer, GTextAlignment alignment){}
+Layer *text_layer_get_layer(TextLayer *layer){ return &layer->layer; }
+
+MenuLayer *menu_layer_create(GRect frame){ return (MenuLayer *)layer_create(frame); }
+void menu_layer_destroy(MenuLayer *layer){ free(layer); }
+void menu_layer_set_callbacks(MenuLayer *layer, void *context, MenuLayerCallbacks callbacks){}
+void menu_layer_set_click_config_onto_window(MenuLayer *layer, Window *window){}
+Layer *menu_layer_get_layer(const MenuLayer *layer){ return (Layer *)&layer->layer; }
+void menu_layer_reload_data(MenuLayer *layer){}
+MenuIndex menu_layer_get_selected_index(const MenuLayer *layer){ return (MenuIndex){ 0, 0 }; }
+void menu_layer_set_selected_index(MenuLayer *layer, MenuIndex index, int align, bool animated){}
+void menu_cell_basic_draw(GContext *ctx, const Layer *layer, const char *title, const char *subtitle, void *icon){}
+
+GFont fonts_get_system_font(const char *key){ return NULL; }
+void graphics_context_set_text_color(GContext *ctx, GColor color){}
+void graphics_context_set_fill_color(GContext *ctx, GColor color){}
+void graphics_context_set_stroke_color(GContext *ctx, GColor color){}
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t radius, GCornerMask mask){}
+void graphics_fill_circle(GContext *ctx, GPoint center, uint16_t radius){}
+void graphics_draw_text(GContext *ctx, const char *text, GFont font, GRect box, GTextOverflowMode mode,
+                        GTextAlignment alignment, GTextAttributes *attributes){}
+GPath *gpath_create(const GPathInfo *info){ return calloc(1, sizeof(GPath)); }
+void gpath_destroy(GPath *path){ free(path); }
+void gpath_move_to(GPath *path, GPoint point){}
+void gpath_rotate_to(GPath *path, int32_t angle){}
+void gpath_draw_filled(GContext *ctx, GPath *path){}
+int32_t sin_lookup(int32_t angle){ return 0; }
+int32_t cos_lookup(int32_t angle){ return TRIG_MAX_RATIO; }
+
+Window *window_create(void){
+  Window *window = calloc(1, sizeof(Window));
+  window->root.frame = GRect(0, 0, 144, 168);
+  return window;
+}
+void window_destroy(Window *window){ free(window); }
+void window_set_background_color(Window *window, GColor color){}
+void window_set_window_handlers(Window *window, WindowHandlers handlers){ window->handlers = handlers; }
+Layer *window_get_root_layer(const Window *window){ return (Layer *)&window->root; }
+void window_set_click_config_provider(Window *window, ClickConfigProvider provider){ window->click_config = provider; }
+
+void window_single_click_subscribe(ButtonId button, ClickHandler handler){ s_single_click[button] = handler; }
+void window_single_repeating_click_subscribe(ButtonId button, uint16_t ms, ClickHandler handler){ s_single_click[button] = handler; }
+void window_long_click_subscribe(ButtonId button, uint16_t delay_ms, ClickHandler down, ClickHandler up){
+  s_long_down[button] = down;
+  s_long_up[button] = up;
+}
+
+static void configure_top_window(){
+  memset(s_single_click, 0, sizeof(s_single_click));
+  memset(s_long_down, 0, sizeof(s_long_down));
+  memset(s_long_up, 0, sizeof(s_long_up));
+  if(s_depth == 0)
+    return;
+  Window *top = s_stack[s_depth - 1];
+  if(top->click_config)
+    top->click_config(top);
+  if(top->handlers.appear)
+    top->handlers.appear(top);
+}
+
+void window_stack_push(Window *window, bool animated){
+  if(s_depth == MAX_WINDOWS)
+    return;
+  if(!window->loaded) {
+    window->loaded = true;
+    if(window->handlers.load)
+      window->handlers.load(window);
+  }
+  s_stack[s_depth++] = window;
+  configure_top_window();
+}
+
+bool window_stack_remove(Window *window, bool animated){
+  for(int i = 0; i < s_depth; i++) {
+    if(s_stack[i] != window)
+      continue;
+    memmove(&s_stack[i], &s_stack[i + 1], (s_depth - i - 1) * sizeof(Window *));
+    s_depth--;
+    if(window->handlers.disappear)
+      window->handlers.disappear(window);
+    if(window->handlers.unload)
+      window->handlers.unload(window);
+    window->loaded = false;
+    if(i == s_depth)
+      configure_top_window();
+    return true;
+  }
+  return false;
+}
+
+Window *window_stack_pop(bool animated){
+  Window *top = s_depth ? s_stack[s_depth - 1] : NULL;
+  if(top)
+    window_stack_remove(top, animated);
+  return top;
+}
+
+Window *window_stack_get_top_window(void){ return s_depth ? s_stack[s_depth - 1] : NULL; }
+
+bool window_stack_contains_window(Window *window){
+  for(int i = 0; i < s_depth; i++) {
+    if(s_stack[i] == window)
+      return true;
+  }
+  return false;
+}
+
+// ---------------- PLATFORM END ----------------
+
+// Time spent computing schedules, measured around every call into alarm.c
+void __real_reschedule_wakeup(void);
+void __wrap_reschedule_wakeup(void){
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  __real_reschedule_wakeup();
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  int64_t ns = (int64_t)(end.tv_sec - start.tv_sec) * 1000000000 + (end.tv_nsec - start.tv_nsec);
+  s_sim->stats.reschedules++;
+  s_sim->stats.reschedule_ns += ns;
+  if(ns > s_sim->stats.reschedule_max_ns)
+    s_sim->stats.reschedule_max_ns = ns;
+}
+
+// ---------------- USER ----------------
+
+typedef enum Behaviour{
+  USER_SETUP,       // first launch, adds the daily alarm
+  USER_BROWSE,      // opens the settings and leaves again
+  USER_DISMISS,     // spins until the alarm is off
+  USER_SNOOZE,      // presses back to snooze
+}Behaviour;
+
+// A resting reading 1.2% off 1 g, as a real sensor gives
+#define REST_READING ((AccelData){ .x = 12, .y = -8, .z = -1012 })
+#define STILL_FEEDS 10
+
+// One compass event or one accelerometer batch, whichever engine is running
+static void feed_sensor(int32_t heading, AccelData reading){
+  if(s_compass_handler) {
+    s_compass_handler((CompassHeadingData){ .true_heading = (heading + TRIG_MAX_ANGLE * 64) % TRIG_MAX_ANGLE,
+                                            .compass_status = CompassStatusCalibrated });
+  } else if(s_accel_handler) {
+    AccelData batch[ACCEL_SPIN_SAMPLES_PER_UPDATE];
+    for(int i = 0; i < ACCEL_SPIN_SAMPLES_PER_UPDATE; i++)
+      batch[i] = reading;
+    s_accel_handler(batch, ACCEL_SPIN_SAMPLES_PER_UPDATE);
+  }
+}
+
+static void spin_until_dismissed(){
+  ClickHandler down = s_long_down[BUTTON_ID_SELECT];
+  ClickHandler up = s_long_up[BUTTON_ID_SELECT];
+  Window *spin_window = window_stack_get_top_window();
+  AccelData spinning = REST_READING;
+  int32_t heading = 0;
+
+  if(!down)
+    return;
+  // The watch lies still while it rings, then while the button is held
+  for(int step = 0; step < STILL_FEEDS; step++)
+    feed_sensor(heading, REST_READING);
+  down(NULL, spin_window);
+  for(int step = 0; step < STILL_FEEDS && window_stack_contains_window(spin_window); step++)
+    feed_sensor(heading, REST_READING);
+  if(!window_stack_contains_window(spin_window)) {
+    s_sim->stats.still_dismissals++;
+    return;
+  }
+  
+  spinning.x += 400;
+  for(int step = 0; step < 200 && window_stack_contains_window(spin_window); step++) {
+    heading -= DEG_TO_TRIGANGLE(10);
+    feed_sensor(heading, spinning);
+  }
+  if(window_stack_contains_window(spin_window)) {
+    s_sim->stats.undismissed++;
+    if(up)
+      up(NULL, spin_window);
+  }
+}
+
+static void user_session(Behaviour behaviour){
+  init();
+  switch(behaviour) {
+    case USER_SETUP: {
+      Alarm alarm = { .hour = ALARM_HOUR, .minute = ALARM_MINUTE, .enabled = true, .alarm_id = -1 };
+      storage_add_alarm(&alarm);
+      break;
+    }
+    case USER_DISMISS:
+      spin_until_dismissed();
+      break;
+    case USER_SNOOZE:
+      if(s_single_click[BUTTON_ID_BACK])
+        s_single_click[BUTTON_ID_BACK](NULL, window_stack_get_top_window());
+      break;
+    case USER_BROWSE:
+      break;
+  }
+  // Session transitions of the launch, decode with tools/session_decode.py
+  if(s_verbose)
+    session_trace_log();
+  // Leave the app
+  while(s_depth)
+    window_stack_pop(false);
+  deinit();
+}
+
+static void launch(AppLaunchReason reason, WakeupId id, int32_t cookie, Behaviour behaviour){
+  s_sim->launch_reason = reason;
+  s_sim->launch_id = id;
+  s_sim->launch_cookie = cookie;
+  s_sim->stats.launches++;
+  fflush(stdout);
+
+  pid_t pid = fork();
+  if(pid == 0) {
+    user_session(behaviour);
+    fflush(stdout);
+    _exit(0);
+  }
+  int status;
+  waitpid(pid, &status, 0);
+  if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "app crashed during launch\n");
+    exit(1);
+  }
+}
+
+// ---------------- USER END ----------------
+
+// ---------------- SCRIPT ----------------
+
+typedef enum EventKind{
+  EVENT_BROWSE,
+  EVENT_CLOCK_JUMP,
+  EVENT_POWER_OFF,
+  EVENT_POWER_ON,
+  EVENT_TIMEZONE,
+}EventKind;
+
+typedef struct Event{
+  int day;
+  int hour;
+  int minute;
+  EventKind kind;
+  int arg;
+  const char *tz;
+}Event;
+
+static const char *s_home_tz = "Europe/London";
+static const char *s_away_tz = "America/New_York";
+
+static void set_timezone(const char *tz){
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+static int local_date(time_t timestamp, int *minute){
+  struct tm *tm = localtime(&timestamp);
+  if(minute)
+    *minute = tm->tm_hour * 60 + tm->tm_min;
+  return (tm->tm_year + 1900) * 10000 + (tm->tm_mon + 1) * 100 + tm->tm_mday;
+}
+
+// Watch-local time of `day` days after the start, converted to true UTC
+static time_t event_time(struct tm *start, int day, int hour, int minute){
+  struct tm tm = *start;
+  tm.tm_mday += day;
+  tm.tm_hour = hour;
+  tm.tm_min = minute;
+  tm.tm_sec = 0;
+  tm.tm_isdst = -1;
+  return mktime(&tm) - s_sim->offset;
+}
+
+static int compare_events(const void *a, const void *b){
+  const Event *x = a, *y = b;
+  if(x->day != y->day)
+    return x->day - y->day;
+  return (x->hour * 60 + x->minute) - (y->hour * 60 + y->minute);
+}
+
+static int build_script(Event *events, int max, int days){
+  int n = 0;
+
+  for(int day = 0; day < days && n < max; day++) {
+    // Most evenings the settings get a look
+    if(day % 5 != 4)
+      events[n++] = (Event){ day, 21, 30, EVENT_BROWSE, 0, NULL };
+  }
+  if(days > 6) {
+    events[n++] = (Event){ 5, 20, 0, EVENT_CLOCK_JUMP, 2 * 60 * 60, NULL };
+    events[n++] = (Event){ 5, 22, 45, EVENT_CLOCK_JUMP, -2 * 60 * 60, NULL };
+  }
+  if(days > 10) {
+    events[n++] = (Event){ 9, 6, 55, EVENT_POWER_OFF, 0, NULL };
+    events[n++] = (Event){ 9, 7, 5, EVENT_POWER_ON, 0, NULL };
+  }
+  if(days > 20) {
+    events[n++] = (Event){ 12, 23, 0, EVENT_TIMEZONE, 0, s_away_tz };
+    events[n++] = (Event){ 19, 23, 0, EVENT_TIMEZONE, 0, s_home_tz };
+  }
+  qsort(events, n, sizeof(Event), compare_events);
+  return n;
+}
+
+static void record_fire(time_t watch_time, bool snooze, bool missed){
+  if(s_sim->num_fires == MAX_FIRES)
+    return;
+  Fire *fire = &s_sim->fires[s_sim->num_fires++];
+  fire->date = local_date(watch_time, &fire->minute);
+  fire->snooze = snooze;
+  fire->missed = missed;
+  if(s_verbose)
+    printf("  %08d %02d:%02d %s%s\n", fire->date, fire->minute / 60, fire->minute % 60,
+           snooze ? "snooze" : "alarm", missed ? " MISSED" : "");
+}
+
+static WakeupSlot *next_wakeup(){
+  WakeupSlot *next = NULL;
+  for(int i = 0; i < MAX_WAKEUPS; i++) {
+    WakeupSlot *slot = &s_sim->wakeups[i];
+    if(slot->used && (!next || slot->timestamp < next->timestamp))
+      next = slot;
+  }
+  return next;
+}
+
+// Wakeups that came due while the watch was off or the clock skipped them only notify
+static void drop_passed_wakeups(){
+  time_t now = host_time(NULL);
+  for(int i = 0; i < MAX_WAKEUPS; i++) {
+    WakeupSlot *slot = &s_sim->wakeups[i];
+    if(slot->used && slot->timestamp < now) {
+      record_fire(slot->timestamp, (slot->cookie & WAKEUP_SNOOZE) != 0, true);
+      slot->used = false;
+    }
+  }
+}
+
+static void fire_wakeup(WakeupSlot *slot, int *ring_count){
+  WakeupSlot fired = *slot;
+  slot->used = false;
+  s_sim->real = fired.timestamp - s_sim->offset;
+  record_fire(fired.timestamp, (fired.cookie & WAKEUP_SNOOZE) != 0, false);
+
+  // Snooze on the first ring of every fourth day, dismiss otherwise
+  int date = local_date(fired.timestamp, NULL);
+  bool snooze = date % 4 == 1 && !(fired.cookie & WAKEUP_SNOOZE) && (*ring_count)++ < MAX_FIRES;
+  launch(APP_LAUNCH_WAKEUP, fired.id, fired.cookie, snooze ? USER_SNOOZE : USER_DISMISS);
+}
+
+static void apply_event(Event *event){
+  switch(event->kind) {
+    case EVENT_BROWSE:
+      if(s_sim->powered)
+        launch(APP_LAUNCH_USER, 0, 0, USER_BROWSE);
+      break;
+    case EVENT_CLOCK_JUMP:
+      s_sim->offset += event->arg;
+      if(s_verbose)
+        printf("  clock set %+d min\n", event->arg / 60);
+      drop_passed_wakeups();
+      break;
+    case EVENT_POWER_OFF:
+      s_sim->powered = false;
+      if(s_verbose)
+        printf("  power off\n");
+      break;
+    case EVENT_POWER_ON:
+      s_sim->powered = true;
+      if(s_verbose)
+        printf("  power on\n");
+      drop_passed_wakeups();
+      break;
+    case EVENT_TIMEZONE:
+      set_timezone(event->tz);
+      if(s_verbose)
+        printf("  timezone %s\n", event->tz);
+      break;
+  }
+}
+
+// ---------------- SCRIPT END ----------------
+
+static void report(struct tm *start, int days){
+  int expected = 0, on_time = 0, missed = 0, missed_off = 0, duplicates = 0, off_time = 0, snoozes = 0;
+
+  for(int i = 0; i < s_sim->num_fires; i++) {
+    Fire *fire = &s_sim->fires[i];
+    if(fire->snooze && !fire->missed)
+      snoozes++;
+  }
+
+  // Every morning after the setup evening should ring once at the alarm time
+  set_timezone(s_home_tz);
+  for(int day = 1; day < days; day++) {
+    struct tm tm = *start;
+    tm.tm_mday += day;
+    tm.tm_hour = 12;
+    tm.tm_isdst = -1;
+    int date = local_date(mktime(&tm), NULL);
+    int rang = 0, skipped = 0;
+    expected++;
+    for(int i = 0; i < s_sim->num_fires; i++) {
+      Fire *fire = &s_sim->fires[i];
+      if(fire->date != date || fire->snooze)
+        continue;
+      if(fire->missed)
+        skipped++;
+      else if(fire->minute == ALARM_HOUR * 60 + ALARM_MINUTE)
+        rang++;
+      else
+        off_time++;
+    }
+    if(rang > 0)
+      on_time++;
+    else if(skipped > 0)
+      missed_off++;
+    else
+      missed++;
+    if(rang > 1)
+      duplicates += rang - 1;
+    if(s_verbose && rang != 1)
+      printf("  %08d rang %d times at the alarm time\n", date, rang);
+  }
+
+  Stats *stats = &s_sim->stats;
+  printf("days %d  launches %d\n", days, stats->launches);
+  printf("alarms expected %d  on time %d  missed %d  missed while off/skipped %d  duplicates %d  off-time %d  snoozes %d  undismissed %d  still dismissals %d\n",
+         expected, on_time, missed, missed_off, duplicates, off_time, snoozes, stats->undismissed,
+         stats->still_dismissals);
+  printf("wakeup syscalls/day %.1f  persist writes/day %.1f  persist reads/day %.1f\n",
+         (double)stats->wakeup_calls / days, (double)stats->persist_writes / days, (double)stats->persist_reads / days);
+  printf("reschedules %d  mean %.1f us  max %.1f us  clock_to_timestamp calls/reschedule %.1f\n",
+         stats->reschedules, stats->reschedules ? stats->reschedule_ns / 1000.0 / stats->reschedules : 0,
+         stats->reschedule_max_ns / 1000.0,
+         stats->reschedules ? (double)stats->clock_calls / stats->reschedules : 0);
+}
+
+int main(int argc, char **argv){
+  const char *start_date = "2026-03-16";
+  int weeks = 6;
+  Event events[128];
+  struct tm start = {0};
+
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--start") == 0 && i + 1 < argc)
+      start_date = argv[++i];
+    else if(strcmp(argv[i], "--weeks") == 0 && i + 1 < argc)
+      weeks = atoi(argv[++i]);
+    else if(strcmp(argv[i], "--tz") == 0 && i + 1 < argc)
+      s_home_tz = argv[++i];
+    else if(strcmp(argv[i], "--battery") == 0 && i + 1 < argc)
+      s_battery = atoi(argv[++i]);
+    else if(strcmp(argv[i], "--verbose") == 0)
+      s_verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--start YYYY-MM-DD] [--weeks N] [--tz ZONE] [--battery PERCENT] [--verbose]\n", argv[0]);
+      return 1;
+    }
+  }
+  if(sscanf(start_date, "%d-%d-%d", &start.tm_year, &start.tm_mon, &start.tm_mday) != 3) {
+    fprintf(stderr, "bad start date %s\n", start_date);
+    return 1;
+  }
+  start.tm_year -= 1900;
+  start.tm_mon -= 1;
+
+  s_sim = mmap(NULL, sizeof(Sim), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(s_sim == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  memset(s_sim, 0, sizeof(Sim));
+  s_sim->powered = true;
+  set_timezone(s_home_tz);
+
+  int days = weeks * 7;
+  int num_events = build_script(events, ARRAY_LENGTH(events), days);
+  time_t end = event_time(&start, days, 0, 0);
+  int ring_count = 0;
+
+  // The user installs the app on the first evening
+  s_sim->real = event_time(&start, 0, 20, 0);
+  launch(APP_LAUNCH_USER, 0, 0, USER_SETUP);
+
+  for(int e = 0; s_sim->real < end;) {
+    WakeupSlot *wakeup = next_wakeup();
+    time_t wakeup_real = wakeup ? wakeup->timestamp - s_sim->offset : end;
+    time_t event_real = e < num_events ? event_time(&start, events[e].day, events[e].hour, events[e].minute) : end;
+
+    if(wakeup && wakeup_real <= event_real && wakeup_real < end) {
+      if(!s_sim->powered) {
+        s_sim->real = wakeup_real;
+        record_fire(wakeup->timestamp, (wakeup->cookie & WAKEUP_SNOOZE) != 0, true);
+        wakeup->used = false;
+        continue;
+      }
+      fire_wakeup(wakeup, &ring_count);
+    } else if(e < num_events && event_real < end) {
+      s_sim->real = event_real > s_sim->real ? event_real : s_sim->real;
+      apply_event(&events[e++]);
+    } else {
+      s_sim->real = end;
+    }
+  }
+
+  report(&start, days);
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Host replay harness for the spin detectors.
+//
+// Replays recorded (or synthetic) sensor traces through both spin engines and
+// scores them against the expected outcome of each trace.
+//
+//   gcc -std=c99 -O2 -Itools/host -Isrc tools/replay.c tools/trace.c src/spin.c src/accel.c -lm -o replay
+//   ./replay trace1.txt trace2.txt ...
+//   ./replay --synth 50
+//
+// See trace.h for the trace format.
+
+#include <pebble.h>
+#include <stdlib.h>
+#include "spin.h"
+#include "accel.h"
+#include "trace.h"
+
+typedef struct Score{
+  int traces;
+  int positives;
+  int detected;
+  int false_dismissals;
+  int64_t latency_ms;
+  int64_t events;
+  int64_t callbacks;
+}Score;
+
+// Host side of the accelerometer service; replay drives the handler itself
+void accel_data_service_subscribe(uint32_t samples_per_update, AccelDataHandler handler){}
+void accel_data_service_unsubscribe(void){}
+int accel_service_set_sampling_rate(AccelSamplingRate rate){ return 0; }
+void host_log(int level, const char *fmt, ...){}
+time_t host_time(time_t *tloc){ return 0; }
+
+static SpinState s_spin;
+static int32_t s_now_ms;
+static int32_t s_dismissed_ms;
+static int s_events;
+
+static void on_heading(int32_t heading){
+  // Before the hold only the baseline heading is tracked, as in set_spin_angle()
+  if(s_now_ms < 0) {
+    s_spin.prev_heading = heading;
+    return;
+  }
+  if(s_dismissed_ms >= 0)
+    return;
+  s_events++;
+  spin_update(&s_spin, heading);
+  if(s_spin.spins >= MAX_SPINS)
+    s_dismissed_ms = s_now_ms;
+}
+
+static void run_engine(Trace *trace, SpinEngine engine, Score *score){
+  AccelSpinState accel;
+  AccelData batch[ACCEL_SPIN_SAMPLES_PER_UPDATE];
+  uint32_t batched = 0;
+  int callbacks = 0;
+  int32_t last_heading = 0;
+
+  spin_reset(&s_spin);
+  s_spin.prev_heading = 0;
+  accel_spin_reset(&accel);
+  s_dismissed_ms = -1;
+  s_events = 0;
+
+  for(int i = 0; i < trace->num_samples; i++) {
+    Sample *sample = &trace->samples[i];
+    s_now_ms = sample->ms;
+    if(engine == SPIN_ENGINE_COMPASS && sample->kind == 'c') {
+      if(!trace_heading_passes(&last_heading, sample->v[0], SPIN_HEADING_FILTER_DEG))
+        continue;
+      callbacks++;
+      on_heading(sample->v[0]);
+    } else if(engine == SPIN_ENGINE_ACCEL && sample->kind == 'a') {
+      batch[batched++] = (AccelData){ .x = sample->v[0], .y = sample->v[1], .z = sample->v[2] };
+      if(batched == ACCEL_SPIN_SAMPLES_PER_UPDATE) {
+        callbacks++;
+        accel_spin_process(&accel, batch, batched, on_heading);
+        batched = 0;
+      }
+    }
+  }
+
+  // Traces count full turns, MAX_SPINS counts half turns
+  bool positive = 2 * trace->spins >= MAX_SPINS;
+  score->traces++;
+  score->events += s_events;
+  score->callbacks += callbacks;
+  if(positive) {
+    score->positives++;
+    if(s_dismissed_ms >= 0) {
+      score->detected++;
+      score->latency_ms += s_dismissed_ms;
+    }
+  } else if(s_dismissed_ms >= 0) {
+    score->false_dismissals++;
+  }
+  printf("  %-8s %-24s spins=%d dismissed=%s at %6d ms  events=%4d callbacks=%4d\n",
+         engine == SPIN_ENGINE_COMPASS ? "compass" : "accel", trace->name, trace->spins,
+         s_dismissed_ms >= 0 ? "yes" : "no ", (int)s_dismissed_ms, s_events, callbacks);
+}
+
+static void print_score(const char *engine, Score *score){
+  int negatives = score->traces - score->positives;
+  printf("%-8s detected %d/%d  false dismissals %d/%d (%d%%)  mean latency %d ms  events/trace %d  callbacks/trace %d\n",
+         engine, score->detected, score->positives, score->false_dismissals, negatives,
+         negatives ? score->false_dismissals * 100 / negatives : 0,
+         score->detected ? (int)(score->latency_ms / score->detected) : -1,
+         score->traces ? (int)(score->events / score->traces) : 0,
+         score->traces ? (int)(score->callbacks / score->traces) : 0);
+}
+
+int main(int argc, char **argv){
+  static Trace trace;
+  Score compass = {0}, accel = {0};
+  int synth = 0;
+
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s [--synth N] [trace...]\n", argv[0]);
+    return 1;
+  }
+
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "--synth") == 0 && i + 1 < argc) {
+      synth = atoi(argv[++i]);
+      continue;
+    }
+    if(!trace_load(argv[i], &trace))
+      return 1;
+    run_engine(&trace, SPIN_ENGINE_COMPASS, &compass);
+    run_engine(&trace, SPIN_ENGINE_ACCEL, &accel);
+  }
+
+  for(int i = 0; i < synth; i++) {
+    // Every fourth trace is a negative: fidgeting, rolling over, holding still or shaking
+    int turns = (i % 4 == 3) ? 0 : 3;
+    trace_synth(&trace, i, 0.3 + 0.05 * (i % 10), turns);
+    run_engine(&trace, SPIN_ENGINE_COMPASS, &compass);
+    run_engine(&trace, SPIN_ENGINE_ACCEL, &accel);
+  }
+
+  print_score("compass", &compass);
+  print_score("accel", &accel);
+  return 0;
+}
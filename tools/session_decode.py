@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+"""Decode alarm session transition traces from the app log.
+
+Select the Latency row in the settings menu to dump the trace, then:
+
+    pebble logs | python tools/session_decode.py
+    python tools/session_decode.py saved.log
+
+Each dump line looks like "SES <count> <offset> <hex>", with 16 hex digits per
+transition (see session_trace_log() in src/session.c).
+"""
+
+import fileinput
+import re
+
+STATES = ['idle', 'ringing', 'holding', 'spinning', 'dismissed', 'snoozed']
+EVENTS = ['alarm', 'tutorial', 'hold', 'release', 'move', 'spun', 'snooze', 'leave']
+# Bit order of the SESSION_* effect flags in src/session.h
+EFFECTS = ['show', 'subscribe', 'light', 'vibe', 'timer', 'reset', 'text', 'redraw',
+           'snooze', 'cancel-timer', 'vibe-stop', 'unsubscribe', 'hide', 'tap', 'tap-stop']
+IGNORED = 0x80
+LINE = re.compile(r'SES (\d+) (\d+) ([0-9a-f]*)')
+
+
+def name(table, index):
+    return table[index] if index < len(table) else str(index)
+
+
+def main():
+    records = []
+    for line in fileinput.input():
+        match = LINE.search(line)
+        if not match:
+            continue
+        offset, data = int(match.group(2)), match.group(3)
+        if offset == 0:
+            records = []
+        for i in range(0, len(data), 16):
+            header, ms = int(data[i:i + 8], 16), int(data[i + 8:i + 16], 16)
+            records.append((header >> 24, (header >> 16) & 0xff, header & 0xffff, ms))
+
+    start = records[0][3] if records else 0
+    ignored = 0
+    for states, event, effects, ms in records:
+        flags = [EFFECTS[bit] for bit in range(len(EFFECTS)) if effects & (1 << bit)]
+        if event & IGNORED:
+            ignored += 1
+            print('{:>8} ms  {:<9} {:<8} ignored'.format(ms - start, name(STATES, states >> 4), name(EVENTS, event & ~IGNORED)))
+            continue
+        print('{:>8} ms  {:<9} {:<8} -> {:<9} {}'.format(
+            ms - start, name(STATES, states >> 4), name(EVENTS, event), name(STATES, states & 0xf), ' '.join(flags)))
+    print('{} transitions, {} ignored events'.format(len(records) - ignored, ignored))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+"""Per-symbol size and static RAM report for an app binary, checked against a budget.
+
+The wscript runs this for every platform after each build. To run it by hand:
+
+    python tools/size_report.py --variant release --platform aplite build/aplite/pebble-app.elf
+
+Symbols are read with `nm -S`. The wscript passes the nm of the configured
+toolchain with --nm; by hand it is --nm, then NM, then arm-none-eabi-nm.
+- "size" is what the loaded binary occupies: code, read-only data and
+  initialised data.
+- "static_ram" is initialised plus zero-initialised data. That memory is
+  gone from the heap before the first malloc.
+
+Budgets are stored per variant and platform in tools/size_budget.json. The
+script exits 1 when a budget is exceeded and 2 when nm could not be run.
+Raise a budget only after deciding the growth is worth it.
+
+The budgets are estimates until they are filled from a real aplite and basalt
+build, so the wscript only enforces them with --size-check.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+EXIT_OVER_BUDGET = 1
+EXIT_TOOL_FAILED = 2
+
+# nm type letter -> (class, counts towards size, counts towards static RAM)
+CLASSES = {
+    't': ('code', True, False),
+    'r': ('rodata', True, False),
+    'd': ('data', True, True),
+    'b': ('bss', False, True),
+}
+
+
+def read_symbols(nm, elf):
+    output = subprocess.check_output([nm, '-S', '--size-sort', elf]).decode()
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) < 4:
+            continue
+        size, kind, name = int(fields[1], 16), fields[2].lower(), ' '.join(fields[3:])
+        if kind in CLASSES:
+            symbols.append((size, CLASSES[kind], name))
+    return symbols
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf')
+    parser.add_argument('--platform', required=True)
+    parser.add_argument('--variant', default='full')
+    parser.add_argument('--budget', default=os.path.join(os.path.dirname(__file__), 'size_budget.json'))
+    parser.add_argument('--top', type=int, default=25, help='largest symbols to list')
+    parser.add_argument('--out', help='also write the report to this file')
+    parser.add_argument('--nm', default=os.environ.get('NM', 'arm-none-eabi-nm'), help='nm to read the symbols with')
+    args = parser.parse_args()
+
+    try:
+        symbols = read_symbols(args.nm, args.elf)
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.stderr.write('size_report: could not run {} on {}: {}\n'.format(args.nm, args.elf, e))
+        return EXIT_TOOL_FAILED
+    totals = dict((cls, 0) for cls, _, _ in CLASSES.values())
+    size = static_ram = 0
+    for bytes_, (cls, in_size, in_ram), _ in symbols:
+        totals[cls] += bytes_
+        size += bytes_ if in_size else 0
+        static_ram += bytes_ if in_ram else 0
+
+    lines = ['{} {} ({})'.format(args.variant, args.platform, args.elf),
+             '  size {}  static_ram {}  ({})'.format(
+                 size, static_ram, '  '.join('{} {}'.format(cls, totals[cls]) for cls in sorted(totals))),
+             '  {:>6}  {:<6}  {}'.format('bytes', 'class', 'symbol')]
+    for bytes_, (cls, _, _), name in sorted(symbols, reverse=True)[:args.top]:
+        lines.append('  {:>6}  {:<6}  {}'.format(bytes_, cls, name))
+
+    failed = False
+    with open(args.budget) as budget_file:
+        budget = json.load(budget_file).get(args.variant, {}).get(args.platform)
+    if budget is None:
+        lines.append('  no budget for {} {}'.format(args.variant, args.platform))
+    else:
+        for key, used in (('size', size), ('static_ram', static_ram)):
+            limit = budget[key]
+            status = 'ok' if used <= limit else 'OVER BUDGET'
+            failed = failed or used > limit
+            lines.append('  {:<10} {:>6} / {:>6}  {}'.format(key, used, limit, status))
+
+    report = '\n'.join(lines)
+    print(report)
+    if args.out:
+        with open(args.out, 'w') as out:
+            out.write(report + '\n')
+    return EXIT_OVER_BUDGET if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
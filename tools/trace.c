@@ -0,0 +1,115 @@
+#include "trace.h"
+#include <math.h>
+#include <stdlib.h>
+
+bool trace_load(const char *path, Trace *trace){
+  char line[128];
+  FILE *file = fopen(path, "r");
+  if(!file) {
+    perror(path);
+    return false;
+  }
+  snprintf(trace->name, sizeof(trace->name), "%s", path);
+  trace->spins = 0;
+  trace->num_samples = 0;
+  while(fgets(line, sizeof(line), file) && trace->num_samples < MAX_SAMPLES) {
+    Sample *sample = &trace->samples[trace->num_samples];
+    if(sscanf(line, "# spins=%d", &trace->spins) == 1)
+      continue;
+    if(sscanf(line, "c %d %d", &sample->ms, &sample->v[0]) == 2) {
+      sample->kind = 'c';
+      trace->num_samples++;
+    } else if(sscanf(line, "a %d %d %d %d", &sample->ms, &sample->v[0], &sample->v[1], &sample->v[2]) == 4) {
+      sample->kind = 'a';
+      trace->num_samples++;
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+bool trace_heading_passes(int32_t *last, int32_t heading, int filter_deg){
+  int32_t diff = TRIGANGLE_TO_DEG(heading - *last);
+  diff = ((diff % 360) + 360) % 360;
+  if(diff > 180)
+    diff = 360 - diff;
+  if(diff < filter_deg)
+    return false;
+  *last = heading;
+  return true;
+}
+
+// ---------------- SYNTHETIC TRACES ----------------
+
+static uint32_t s_seed = 1;
+
+static int32_t noise(int32_t amplitude){
+  s_seed = s_seed * 1103515245 + 12345;
+  return amplitude ? (int32_t)((s_seed >> 8) % (2 * amplitude + 1)) - amplitude : 0;
+}
+
+// The watch rests this long before the hold, the accel engine measures gravity in it
+#define PRE_HOLD_MS 2000
+
+// What a wearer does without meaning to dismiss, cycling over the negatives
+typedef enum Negative{
+  NEGATIVE_FIDGET,
+  NEGATIVE_ROLL,    // rolls over in bed
+  NEGATIVE_STILL,   // holds the button without moving, on a sensor reading 2% high
+  NEGATIVE_SHAKE,   // shakes the arm back and forth without turning
+  NUM_NEGATIVES
+}Negative;
+
+static const char *NEGATIVE_NAMES[NUM_NEGATIVES] = { "", "-roll", "-still", "-shake" };
+
+void trace_synth(Trace *trace, int index, double rev_per_s, int turns){
+  double duration_ms = turns ? turns * 1000.0 / rev_per_s : 8000.0;
+  double omega = rev_per_s * 2 * 3.14159265;
+  Negative negative = (index / 4) % NUM_NEGATIVES;
+  // Every third trace comes from a sensor with a gain and offset error, still ones always do
+  bool skewed = index % 3 == 0 || (!turns && negative == NEGATIVE_STILL);
+  double gain = skewed ? 1.02 : 1.0;
+  int32_t offset[3] = { skewed ? 15 : 0, skewed ? -10 : 0, skewed ? -20 : 0 };
+  double shake_hz = 1.0 + 0.5 * (index % 3);
+
+  snprintf(trace->name, sizeof(trace->name), "synth-%02d-%.2frps%s%s", index, rev_per_s,
+           turns ? "" : NEGATIVE_NAMES[negative], skewed ? "-skew" : "");
+  trace->spins = turns;
+  trace->num_samples = 0;
+
+  for(int32_t ms = -PRE_HOLD_MS; ms < duration_ms && trace->num_samples < MAX_SAMPLES - 2; ms += 40) {
+    double t = ms / 1000.0;
+    double heading_deg = 0;
+    double accel[3] = { 0, 150, -988 };
+    int32_t jitter = 20;
+    if(ms < 0) {
+      // Lying still while the alarm rings
+    } else if(turns) {
+      heading_deg = -360.0 * rev_per_s * t;
+      accel[0] += omega * omega * 0.4 / 9.81 * 1000;
+      jitter = 40;
+    } else if(negative == NEGATIVE_ROLL) {
+      heading_deg = ms < 4000 ? -150.0 * ms / 4000 : -150.0 + 150.0 * (ms - 4000) / 4000;
+      jitter = 120;
+    } else if(negative == NEGATIVE_SHAKE) {
+      double swing = 1200 * sin(2 * 3.14159265 * shake_hz * t);
+      heading_deg = 10 * sin(2 * 3.14159265 * shake_hz * t);
+      accel[0] += 0.6 * swing;
+      accel[1] += 0.8 * swing;
+      jitter = 60;
+    } else if(negative == NEGATIVE_FIDGET) {
+      heading_deg = 20.0 * ((ms / 700) % 3 - 1);
+      jitter = 120;
+    }
+    int32_t heading = (int32_t)((heading_deg + noise(3)) * TRIG_MAX_ANGLE / 360.0);
+    heading = ((heading % TRIG_MAX_ANGLE) + TRIG_MAX_ANGLE) % TRIG_MAX_ANGLE;
+    trace->samples[trace->num_samples++] = (Sample){ 'c', ms, { heading, 0, 0 } };
+
+    Sample *sample = &trace->samples[trace->num_samples++];
+    *sample = (Sample){ 'a', ms, { 0, 0, 0 } };
+    for(int axis = 0; axis < 3; axis++)
+      sample->v[axis] = (int32_t)((accel[axis] + noise(jitter)) * gain) + offset[axis];
+  }
+}
+
+// ---------------- SYNTHETIC TRACES END ----------------
@@ -0,0 +1,34 @@
+#pragma once
+
+// Sensor traces shared by the host tools.
+//
+// Trace format, one sample per line, timestamps in ms since the hold started.
+// Samples before the hold (negative ms) are the watch resting while it rings:
+//   # spins=2                   number of full turns the wearer made
+//   c <ms> <true_heading>       raw compass sample, before the heading filter
+//   a <ms> <x> <y> <z>          accelerometer sample in mg
+
+#include <pebble.h>
+
+#define MAX_SAMPLES 8192
+
+typedef struct Sample{
+  char kind;
+  int32_t ms;
+  int32_t v[3];
+}Sample;
+
+typedef struct Trace{
+  char name[64];
+  int spins;
+  int num_samples;
+  Sample samples[MAX_SAMPLES];
+}Trace;
+
+bool trace_load(const char *path, Trace *trace);
+// A wearer spinning at rev_per_s for `turns` turns after resting for two seconds.
+// 0 turns is a negative: fidgeting, rolling over, holding still or shaking the arm.
+// Every third index adds a sensor gain and offset error.
+void trace_synth(Trace *trace, int index, double rev_per_s, int turns);
+// Emulates the compass service heading filter, last holds the previously delivered heading
+bool trace_heading_passes(int32_t *last, int32_t heading, int filter_deg);